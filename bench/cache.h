@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/bitset.h"
+#include "../src/cache.h"
+#include "timer.h"
+
+enum {
+  NUM_OF_IDS_PER_SET = 16,
+  ID_RANGE = 1 << 12,
+  NUM_OF_LOOKUPS = 1 << 20,
+};
+
+static Bitset* create_random_states() {
+  Bitset* states = create_bitset(ID_RANGE);
+  for (int i = 0; i < NUM_OF_IDS_PER_SET; i++) {
+    insert_bitset(states, rand() % ID_RANGE);
+  }
+  return states;
+}
+
+/// @brief Looks up the cached DFA states with caches of growing sizes. The
+/// time of a lookup should stay flat regardless of the size of the cache.
+static void bench_find_dstate() {
+  printf("find_dstate: %d lookups, %d of %d NFA states per DFA state\n",
+         NUM_OF_LOOKUPS, NUM_OF_IDS_PER_SET, ID_RANGE);
+  printf("%12s %16s\n", "dfa states", "ns per lookup");
+  srand(0);
+  for (int num_of_dstates = 1 << 8; num_of_dstates <= 1 << 16;
+       num_of_dstates <<= 2) {
+    DfaCache* cache = create_dfa_cache(NULL, NULL, 0);
+    Bitset** lookups = malloc(sizeof(Bitset*) * num_of_dstates);
+    for (int i = 0; i < num_of_dstates; i++) {
+      lookups[i] = create_random_states();
+      // the cache takes the ownership, so cache a copy instead
+      cache_dstate(cache, create_dfa_state(copy_bitset(lookups[i]), false));
+    }
+
+    int num_of_found = 0;
+    const double start = now_ns();
+    for (int i = 0; i < NUM_OF_LOOKUPS; i++) {
+      num_of_found += find_dstate(cache, lookups[i % num_of_dstates]) != NULL;
+    }
+    const double elapsed = now_ns() - start;
+    if (num_of_found != NUM_OF_LOOKUPS) {
+      fprintf(stderr, "find_dstate: missing cached DFA states\n");
+    }
+    printf("%12d %16.1f\n", num_of_dstates, elapsed / NUM_OF_LOOKUPS);
+
+    for (int i = 0; i < num_of_dstates; i++) {
+      delete_bitset(lookups[i]);
+    }
+    free(lookups);
+    delete_dfa_cache(cache);
+  }
+}
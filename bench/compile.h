@@ -0,0 +1,54 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/regexp.h"
+#include "timer.h"
+
+/// @brief From 1 KB to 10 MB.
+static const size_t PATTERN_SIZES[] = {1 << 10, 10 << 10, 100 << 10, 1 << 20,
+                                       10 << 20};
+
+/// @return An alternation of hostnames which takes at most size bytes, such as
+/// "host0.example.com|host1.example.com", which the caller frees.
+static char* create_hostname_alternation(size_t size) {
+  char* re = malloc(size + 1);
+  size_t len = 0;
+  char word[32];
+  for (int i = 0;; i++) {
+    const int word_len = snprintf(word, sizeof(word), "%shost%d.example.com",
+                                  i ? "|" : "", i);
+    if (len + word_len > size) {
+      break;
+    }
+    memcpy(re + len, word, word_len);
+    len += word_len;
+  }
+  re[len] = '\0';
+  return re;
+}
+
+/// @brief Compiles alternations of growing sizes with each construction. The
+/// time per byte should stay flat regardless of the size of the pattern.
+static void bench_compile() {
+  printf("compile alternations of hostnames\n");
+  printf("%12s %12s %12s %16s\n", "bytes", "compiler", "ms", "ns per byte");
+  for (size_t i = 0; i < sizeof(PATTERN_SIZES) / sizeof(size_t); i++) {
+    char* re = create_hostname_alternation(PATTERN_SIZES[i]);
+    const size_t len = strlen(re);
+    for (int glushkov = 0; glushkov < 2; glushkov++) {
+      RegexpOptions options;
+      init_regexp_options(&options);
+      options.glushkov = glushkov;
+      const double start = now_ns();
+      Regexp* regexp = compile_regexp(re, &options);
+      const double elapsed_ns = now_ns() - start;
+      printf("%12zu %12s %12.1f %16.1f\n", len,
+             glushkov ? "glushkov" : "thompson", elapsed_ns / 1e6,
+             elapsed_ns / len);
+      delete_regexp(regexp);
+    }
+    free(re);
+  }
+}
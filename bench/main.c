@@ -0,0 +1,15 @@
+#include "cache.h"
+#include "compile.h"
+#include "match.h"
+
+int main(void) {
+  // cache.h
+  bench_find_dstate();
+  // compile.h
+  bench_compile();
+  // match.h
+  bench_match_engines("(a|b)*abb");
+  bench_match_engines("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)");
+  bench_match_engines("[ab]*a[ab][ab][ab][ab][ab][ab][ab]");
+  return 0;
+}
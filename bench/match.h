@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/bitvm.h"
+#include "../src/byteclass.h"
+#include "../src/pikevm.h"
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+#include "../src/regexp.h"
+#include "../src/shiftand.h"
+#include "timer.h"
+
+enum {
+  TEXT_SIZE = 1 << 20,
+};
+
+/// @return A random string of a and b, which the caller frees.
+static char* create_random_text() {
+  char* text = malloc(TEXT_SIZE + 1);
+  for (int i = 0; i < TEXT_SIZE; i++) {
+    text[i] = "ab"[rand() % 2];
+  }
+  text[TEXT_SIZE] = '\0';
+  return text;
+}
+
+static void print_throughput(const char* engine, double elapsed_ns) {
+  printf("%12s %16.1f\n", engine, TEXT_SIZE / (elapsed_ns / 1e9) / 1e6);
+}
+
+/// @brief Matches a long text with each of the engines.
+static void bench_match_engines(const char* re) {
+  printf("match \"%s\" against %d bytes\n", re, TEXT_SIZE);
+  printf("%12s %16s\n", "engine", "MB per second");
+  srand(0);
+  char* text = create_random_text();
+  Nfa* nfa = re2nfa(re);
+  Prog* prog = create_prog(nfa);
+  ByteClasses classes;
+  compute_byte_classes(prog, &classes);
+
+  PikeVm* pike_vm = create_pike_vm(prog);
+  double start = now_ns();
+  run_pike_vm(pike_vm, text, TEXT_SIZE);
+  print_throughput("pike vm", now_ns() - start);
+  delete_pike_vm(pike_vm);
+
+  BitVm* bit_vm = create_bit_vm(prog, &classes);
+  start = now_ns();
+  run_bit_vm(bit_vm, text, TEXT_SIZE);
+  print_throughput("bitset vm", now_ns() - start);
+  delete_bit_vm(bit_vm);
+
+  ShiftAnd* shift_and = create_shift_and(prog);
+  start = now_ns();
+  run_shift_and(shift_and, text, TEXT_SIZE);
+  print_throughput("shift-and", now_ns() - start);
+  delete_shift_and(shift_and);
+
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.cache = true;
+  Regexp* regexp = compile_regexp(re, &options);
+  start = now_ns();
+  match_regexp_n(regexp, text, TEXT_SIZE);
+  print_throughput("lazy dfa", now_ns() - start);
+  delete_regexp(regexp);
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+  free(text);
+}
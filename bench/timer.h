@@ -0,0 +1,13 @@
+#ifndef BENCH_TIMER_H
+#define BENCH_TIMER_H
+
+#include <time.h>
+
+/// @return The current time of a monotonic clock in nanoseconds.
+static double now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+#endif /* end of include guard: BENCH_TIMER_H */
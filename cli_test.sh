@@ -108,6 +108,199 @@ if make clean >/dev/null 2>&1 && make ${BUILD_MODE} >/dev/null 2>&1; then
         pass_count=$((pass_count + 1))
     fi
 
+    echo_in_yellow "${RUN_BANNER} Normal matched (dfa)"
+    args="-d (a|b)*abb ababb"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if ! echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 0"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Normal unmatched (dfa)"
+    args="-d (a|b)*abb abab"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Normal matched (glushkov)"
+    args="-G (a|b)*abb ababb"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if ! echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 0"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Normal unmatched (glushkov)"
+    args="-G (a|b)*abb abab"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Bracket expression matched"
+    args="[a-c]+[^0-9] abcx"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if ! echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 0"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} UTF-8 character matched"
+    args="-u [α-ω]+. λογος!"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if ! echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 0"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Stdin matched"
+    args="-f - (a|b)*abb"
+    echo "${BODY_BANNER} printf bababb | ${EXEC} ${args}"
+    if ! printf "bababb" | ${EXEC} ${args} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 0"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} File unmatched"
+    INPUT="input.txt"
+    echo "${BODY_BANNER} set-up: Writing ${INPUT}..."
+    printf "bababb\n" > "${INPUT}"
+    args="-f ${INPUT} (a|b)*abb"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+    echo "${BODY_BANNER} tear-down: Removing ${INPUT}..."
+    rm -f "${INPUT}"
+
+    echo_in_yellow "${RUN_BANNER} File unreadable"
+    INPUT_DIR="input.d"
+    echo "${BODY_BANNER} set-up: Making directory ${INPUT_DIR}..."
+    mkdir -p "${INPUT_DIR}"
+    args="-f ${INPUT_DIR} a*"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+    echo "${BODY_BANNER} tear-down: Removing directory ${INPUT_DIR}..."
+    rmdir "${INPUT_DIR}"
+
+    echo_in_yellow "${RUN_BANNER} Grep lines counted"
+    INPUT="input.txt"
+    echo "${BODY_BANNER} set-up: Writing ${INPUT}..."
+    printf "abb\nab\nbabb\n" > "${INPUT}"
+    args="-p -C (a|b)*abb ${INPUT}"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    output=$(echo "${args}" | xargs ${EXEC} 2>/dev/null | tail -n 1)
+    if [ "${output}" != "2" ]; then
+        echo_in_red "${FAILED_BANNER} should print 2, got \"${output}\""
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Grep lines in parallel"
+    args="-p -j 2 (a|b)*abb ${INPUT}"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    output=$(echo "${args}" | xargs ${EXEC} 2>/dev/null | tail -n 2 | tr '\n' ' ')
+    if [ "${output}" != "abb babb " ]; then
+        echo_in_red "${FAILED_BANNER} should print \"abb babb \", got \"${output}\""
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Grep unmatched"
+    args="-p c+ ${INPUT}"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+    echo "${BODY_BANNER} tear-down: Removing ${INPUT}..."
+    rm -f "${INPUT}"
+
+    echo_in_yellow "${RUN_BANNER} Search matched"
+    args="-s ab+a xxabbbaxx"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if ! echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 0"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Normal matched (cache with budget)"
+    args="-c -m 1K (a|b)*abb ababb"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if ! echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 0"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Max memory set without cache"
+    args="-m 1K (a|b)*abb ababb"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
+    echo_in_yellow "${RUN_BANNER} Invalid max memory"
+    args="-c -m 1X (a|b)*abb ababb"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
+
     echo_in_yellow "${RUN_BANNER} Ill-formed regex"
     args="(a|b*abb ababb"
     echo "${BODY_BANNER} ${EXEC} ${args}"
@@ -212,6 +405,17 @@ if make clean >/dev/null 2>&1 && make ${BUILD_MODE} >/dev/null 2>&1; then
         echo_in_green "${OK_BANNER}"
         pass_count=$((pass_count + 1))
     fi
+
+    echo_in_yellow "${RUN_BANNER} Glushkov option set under graph mode"
+    args="-g -G (a|b)*abb"
+    echo "${BODY_BANNER} ${EXEC} ${args}"
+    if echo "${args}" | xargs ${EXEC} >/dev/null 2>&1; then
+        echo_in_red "${FAILED_BANNER} should exit 1"
+        fail_count=$((fail_count + 1))
+    else
+        echo_in_green "${OK_BANNER}"
+        pass_count=$((pass_count + 1))
+    fi
     # tail of test cases
     echo_in_yellow "${SECTION_BANNER} $((pass_count + fail_count)) tests ran."
 else
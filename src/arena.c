@@ -0,0 +1,70 @@
+#include "arena.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/// @brief The alignment of every allocation, which suits any type.
+enum { ARENA_ALIGNMENT = 16 };
+
+typedef struct Chunk {
+  /// @brief The chunk allocated before this one; NULL if none.
+  struct Chunk* prev;
+  size_t capacity;
+  size_t used;
+  unsigned char data[] __attribute__((aligned(ARENA_ALIGNMENT)));
+} Chunk;
+
+struct Arena {
+  /// @brief The chunk being allocated from, which is the latest one.
+  Chunk* curr;
+  size_t memory;
+};
+
+static Chunk* create_chunk(size_t capacity, Chunk* prev) {
+  Chunk* chunk = malloc(sizeof(Chunk) + capacity);
+  chunk->prev = prev;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  return chunk;
+}
+
+Arena* create_arena() {
+  Arena* arena = malloc(sizeof(Arena));
+  arena->curr = create_chunk(ARENA_BASE_CAPACITY, NULL);
+  arena->memory = sizeof(Chunk) + ARENA_BASE_CAPACITY;
+  return arena;
+}
+
+void delete_arena(Arena* arena) {
+  Chunk* chunk = arena->curr;
+  while (chunk) {
+    Chunk* prev = chunk->prev;
+    free(chunk);
+    chunk = prev;
+  }
+  free(arena);
+}
+
+/// @details A new chunk at least twice as large as the current one is started
+/// if the current one runs out of room, so the number of chunks is
+/// logarithmic to the memory allocated. The room left in the previous chunk is
+/// never used again.
+void* alloc_arena(Arena* arena, size_t size) {
+  size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+  Chunk* chunk = arena->curr;
+  if (chunk->capacity - chunk->used < size) {
+    size_t capacity = chunk->capacity * 2;
+    while (capacity < size) {
+      capacity *= 2;
+    }
+    chunk = arena->curr = create_chunk(capacity, chunk);
+    arena->memory += sizeof(Chunk) + capacity;
+  }
+  void* ptr = chunk->data + chunk->used;
+  chunk->used += size;
+  return ptr;
+}
+
+size_t get_arena_memory(const Arena* arena) {
+  return arena->memory;
+}
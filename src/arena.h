@@ -0,0 +1,29 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#ifndef ARENA_BASE_CAPACITY
+/// @brief Define before including this file if you want to use another size
+/// of the first chunk of an arena, in bytes.
+#define ARENA_BASE_CAPACITY 4096
+#endif
+
+/// @brief A bump allocator. Allocations are carved out of chunks which grow
+/// geometrically, and are all released at once when the arena is deleted.
+typedef struct Arena Arena;
+
+/// @note Should be freed after use with delete_arena.
+Arena* create_arena();
+
+/// @brief Frees all the memory allocated from the arena.
+void delete_arena(Arena*);
+
+/// @return Uninitialized memory of size bytes, which is suitably aligned for
+/// any type and lives as long as the arena.
+void* alloc_arena(Arena*, size_t size);
+
+/// @return The number of bytes taken by the chunks of the arena.
+size_t get_arena_memory(const Arena*);
+
+#endif /* end of include guard: ARENA_H */
@@ -13,11 +13,13 @@ https://opensource.org/license/mit/.
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
 #include "colors.h"
 #include "messages.h"
 
+/* The number of threads is capped so that a typo can't exhaust the system */
+#define MAX_JOBS 1024
+
 /*
  * Sets the default options
  */
@@ -25,10 +27,65 @@ static void set_default_options(Options* options) {
   options->help = false;
   options->version = false;
   options->cache = false;
+  options->max_memory = 0;
+  options->stats = false;
+  options->dfa = false;
+  options->glushkov = false;
   options->graph = false;
-  strncpy(options->filename, "nfa", BUF_SIZE);
-  options->regexp[0] = '\0';
-  options->string[0] = '\0';
+  options->utf8 = false;
+  options->search = false;
+  options->filename = "nfa";
+  options->input = NULL;
+  options->grep = false;
+  options->count = false;
+  options->files_with_matches = false;
+  options->jobs = 1;
+  options->files = NULL;
+  options->num_of_files = 0;
+  options->regexp = "";
+  options->string = "";
+}
+
+/*
+ * Parses a number of bytes with an optional K, M or G suffix
+ */
+static size_t parse_size(const char* arg) {
+  char* end;
+  size_t size = strtoull(arg, &end, 10);
+  switch (*end) {
+    case 'G':
+      size *= 1024;
+      /* fall through */
+    case 'M':
+      size *= 1024;
+      /* fall through */
+    case 'K':
+      size *= 1024;
+      end++;
+      break;
+    default:
+      break;
+  }
+  if (end == arg || *end != '\0' || size == 0) {
+    fprintf(stderr, "invalid size: \"%s\"\n", arg);
+    usage();
+    exit(EXIT_FAILURE);
+  }
+  return size;
+}
+
+/*
+ * Parses a positive number of threads
+ */
+static int parse_jobs(const char* arg) {
+  char* end;
+  const long jobs = strtol(arg, &end, 10);
+  if (end == arg || *end != '\0' || jobs <= 0 || jobs > MAX_JOBS) {
+    fprintf(stderr, "invalid number of jobs: \"%s\"\n", arg);
+    usage();
+    exit(EXIT_FAILURE);
+  }
+  return jobs;
 }
 
 /*
@@ -50,10 +107,54 @@ void switch_options(int arg, Options* options) {
       options->cache = true;
       break;
 
+    case 'm':
+      options->max_memory = parse_size(optarg);
+      break;
+
+    case 'S':
+      options->stats = true;
+      break;
+
+    case 'd':
+      options->dfa = true;
+      break;
+
+    case 'G':
+      options->glushkov = true;
+      break;
+
     case 'g':
       options->graph = true;
       break;
 
+    case 'u':
+      options->utf8 = true;
+      break;
+
+    case 's':
+      options->search = true;
+      break;
+
+    case 'f':
+      options->input = optarg;
+      break;
+
+    case 'p':
+      options->grep = true;
+      break;
+
+    case 'C':
+      options->count = true;
+      break;
+
+    case 'l':
+      options->files_with_matches = true;
+      break;
+
+    case 'j':
+      options->jobs = parse_jobs(optarg);
+      break;
+
     case 'o':
       if (!options->graph) {
         fprintf(stderr,
@@ -61,7 +162,7 @@ void switch_options(int arg, Options* options) {
         usage();
         exit(EXIT_FAILURE);
       }
-      strncpy(options->filename, optarg, BUF_SIZE);
+      options->filename = optarg;
       break;
 
     case '?':
@@ -76,7 +177,7 @@ void switch_options(int arg, Options* options) {
 
 void get_regexp(int argc, char* argv[], Options* options) {
   if (optind < argc) {
-    strncpy(options->regexp, argv[optind++], BUF_SIZE);
+    options->regexp = argv[optind++];
   } else {
     usage();
     exit(EXIT_FAILURE);
@@ -85,7 +186,22 @@ void get_regexp(int argc, char* argv[], Options* options) {
 
 void get_string(int argc, char* argv[], Options* options) {
   if (optind < argc) {
-    strncpy(options->string, argv[optind++], BUF_SIZE);
+    options->string = argv[optind++];
+  } else {
+    usage();
+    exit(EXIT_FAILURE);
+  }
+}
+
+/*
+ * Takes all the remaining arguments as the files, of which there is at least
+ * one
+ */
+void get_files(int argc, char* argv[], Options* options) {
+  if (optind < argc) {
+    options->files = argv + optind;
+    options->num_of_files = argc - optind;
+    optind = argc;
   } else {
     usage();
     exit(EXIT_FAILURE);
@@ -102,14 +218,29 @@ void options_parser(int argc, char* argv[], Options* options) {
 
   /* getopt allowed options */
   static struct option long_options[] = {
-      {"help", no_argument, 0, 'h'},         {"version", no_argument, 0, 'V'},
-      {"cache", no_argument, 0, 'c'},        {"graph", no_argument, 0, 'g'},
-      {"output", required_argument, 0, 'o'}, {0, 0, 0, 0},
+      {"help", no_argument, 0, 'h'},
+      {"version", no_argument, 0, 'V'},
+      {"cache", no_argument, 0, 'c'},
+      {"max-memory", required_argument, 0, 'm'},
+      {"stats", no_argument, 0, 'S'},
+      {"dfa", no_argument, 0, 'd'},
+      {"glushkov", no_argument, 0, 'G'},
+      {"graph", no_argument, 0, 'g'},
+      {"output", required_argument, 0, 'o'},
+      {"utf8", no_argument, 0, 'u'},
+      {"search", no_argument, 0, 's'},
+      {"file", required_argument, 0, 'f'},
+      {"grep", no_argument, 0, 'p'},
+      {"count", no_argument, 0, 'C'},
+      {"files-with-matches", no_argument, 0, 'l'},
+      {"jobs", required_argument, 0, 'j'},
+      {0, 0, 0, 0},
   };
 
   while (true) {
     int option_index = 0;
-    arg = getopt_long(argc, argv, "hVcgo:", long_options, &option_index);
+    arg = getopt_long(argc, argv, "hVcm:SdGgo:usf:pClj:", long_options,
+                      &option_index);
 
     /* End of the options? */
     if (arg == -1) {
@@ -119,10 +250,52 @@ void options_parser(int argc, char* argv[], Options* options) {
     switch_options(arg, options);
   }
 
-  /* Both graph and match mode take a regexp */
+  /* The grep mode caches the DFA states unless it builds the full DFA */
+  if (options->max_memory && !options->cache && !options->dfa
+      && !options->grep) {
+    fprintf(stderr,
+            "option --max-memory has to be used together with --cache,"
+            " --dfa or --grep\n");
+    usage();
+    exit(EXIT_FAILURE);
+  }
+
+  /* The graph is of the NFA, which Glushkov's construction doesn't build */
+  if (options->glushkov && options->graph) {
+    fprintf(stderr, "option --glushkov can't be used together with --graph\n");
+    usage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (options->input && options->graph) {
+    fprintf(stderr, "option --file can't be used together with --graph\n");
+    usage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (options->grep && (options->graph || options->input)) {
+    fprintf(stderr,
+            "option --grep can't be used together with --graph or --file\n");
+    usage();
+    exit(EXIT_FAILURE);
+  }
+
+  if ((options->count || options->files_with_matches || options->jobs > 1)
+      && !options->grep) {
+    fprintf(stderr,
+            "options --count, --files-with-matches and --jobs have to be used"
+            " together with --grep\n");
+    usage();
+    exit(EXIT_FAILURE);
+  }
+
+  /* All the modes take a regexp */
   get_regexp(argc, argv, options);
 
-  if (!options->graph) {
+  if (options->grep) {
+    get_files(argc, argv, options);
+  } else if (!options->graph && !options->input) {
+    /* The file takes the place of the string */
     get_string(argc, argv, options);
   }
   if (optind < argc) {
@@ -11,18 +11,35 @@ https://opensource.org/license/mit/.
 #define ARGS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
-#define BUF_SIZE 100
-
-/* Defines the command line allowed options struct */
+/* Defines the command line allowed options struct; strings point into argv */
 struct options {
   bool help;
   bool version;
   bool cache;
+  /* The budget of the cache in bytes; 0 if unlimited */
+  size_t max_memory;
+  bool stats;
+  bool dfa;
+  bool glushkov;
   bool graph;
-  char filename[BUF_SIZE];
-  char regexp[BUF_SIZE];
-  char string[BUF_SIZE];
+  bool utf8;
+  bool search;
+  /* The name of the dot file of --graph, without the extension */
+  const char* filename;
+  /* The file to match instead of the string; "-" for stdin, NULL if none */
+  const char* input;
+  bool grep;
+  bool count;
+  bool files_with_matches;
+  /* The number of threads to grep each file with */
+  int jobs;
+  /* The files to grep, which are pointed to in argv */
+  char** files;
+  int num_of_files;
+  const char* regexp;
+  const char* string;
 };
 
 /* Exports options as a global type */
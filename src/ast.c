@@ -0,0 +1,860 @@
+#include "ast.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "byteset.h"
+#include "re2post.h"
+
+static Ast* create_ast(Arena* arena, AstKind kind) {
+  Ast* ast = alloc_arena(arena, sizeof(Ast));
+  ast->kind = kind;
+  ast->nullable = kind == AST_EMPTY || kind == AST_STAR || kind == AST_QUEST;
+  ast->byte = 0;
+  ast->set = NULL;
+  ast->first = ast->last = ast->prev = ast->next = NULL;
+  return ast;
+}
+
+static Ast* create_byte_ast(Arena* arena, unsigned char byte) {
+  Ast* ast = create_ast(arena, AST_BYTE);
+  ast->byte = byte;
+  return ast;
+}
+
+/// @return The node which takes the bytes of the set, which is AST_BYTE if
+/// there is a single one and AST_ANY if there are all of them.
+static Ast* create_class_ast(Arena* arena, const ByteSet* set) {
+  const int num_of_bytes = count_byte_set(set);
+  if (num_of_bytes == 1) {
+    return create_byte_ast(arena, min_byte_set(set));
+  }
+  if (num_of_bytes == NUM_OF_BYTES) {
+    return create_ast(arena, AST_ANY);
+  }
+  Ast* ast = create_ast(arena, AST_CLASS);
+  ast->set = alloc_arena(arena, sizeof(ByteSet));
+  *ast->set = *set;
+  return ast;
+}
+
+static bool is_list(const Ast* ast) {
+  return ast->kind == AST_CONCAT || ast->kind == AST_UNION;
+}
+
+static bool is_repetition(const Ast* ast) {
+  return ast->kind == AST_STAR || ast->kind == AST_PLUS
+         || ast->kind == AST_QUEST;
+}
+
+static void append_sub(Ast* parent, Ast* sub) {
+  sub->prev = parent->last;
+  sub->next = NULL;
+  if (parent->last) {
+    parent->last->next = sub;
+  } else {
+    parent->first = sub;
+  }
+  parent->last = sub;
+}
+
+static void prepend_sub(Ast* parent, Ast* sub) {
+  sub->prev = NULL;
+  sub->next = parent->first;
+  if (parent->first) {
+    parent->first->prev = sub;
+  } else {
+    parent->last = sub;
+  }
+  parent->first = sub;
+}
+
+/// @brief Moves the subexpressions of the list to the end of the parent.
+static void append_subs(Ast* parent, Ast* list) {
+  if (!parent->last) {
+    parent->first = list->first;
+  } else {
+    parent->last->next = list->first;
+    list->first->prev = parent->last;
+  }
+  parent->last = list->last;
+  list->first = list->last = NULL;
+}
+
+static void remove_sub(Ast* parent, Ast* sub) {
+  if (sub->prev) {
+    sub->prev->next = sub->next;
+  } else {
+    parent->first = sub->next;
+  }
+  if (sub->next) {
+    sub->next->prev = sub->prev;
+  } else {
+    parent->last = sub->prev;
+  }
+  sub->prev = sub->next = NULL;
+}
+
+/// @brief Replaces the subexpression with another one, whose subexpressions
+/// are spliced in place if it's a list of the same kind as the parent.
+static void replace_sub(Ast* parent, Ast* sub, Ast* with) {
+  Ast* prev = sub->prev;
+  Ast* next = sub->next;
+  Ast* first = with;
+  Ast* last = with;
+  if (is_list(parent) && with->kind == parent->kind) {
+    first = with->first;
+    last = with->last;
+  }
+  first->prev = prev;
+  last->next = next;
+  if (prev) {
+    prev->next = first;
+  } else {
+    parent->first = first;
+  }
+  if (next) {
+    next->prev = last;
+  } else {
+    parent->last = last;
+  }
+}
+
+static void update_nullable(Ast* ast) {
+  if (is_list(ast)) {
+    const bool is_concat = ast->kind == AST_CONCAT;
+    ast->nullable = is_concat;
+    for (const Ast* sub = ast->first; sub; sub = sub->next) {
+      if (sub->nullable != is_concat) {
+        ast->nullable = sub->nullable;
+        break;
+      }
+    }
+  } else if (ast->kind == AST_PLUS) {
+    ast->nullable = ast->first->nullable;
+  }
+}
+
+/// @return The list of the kind with the subexpressions of x followed by the
+/// ones of y, where a list of the same kind is spliced.
+static Ast* create_list(Arena* arena, AstKind kind, Ast* x, Ast* y) {
+  Ast* list = x;
+  if (x->kind != kind) {
+    list = create_ast(arena, kind);
+    append_sub(list, x);
+  }
+  if (y->kind == kind) {
+    append_subs(list, y);
+  } else {
+    append_sub(list, y);
+  }
+  list->nullable = kind == AST_CONCAT ? x->nullable && y->nullable
+                                      : x->nullable || y->nullable;
+  return list;
+}
+
+static Ast* create_repetition(Arena* arena, AstKind kind, Ast* sub) {
+  Ast* repetition = create_ast(arena, kind);
+  append_sub(repetition, sub);
+  update_nullable(repetition);
+  return repetition;
+}
+
+/// @return The empty string if the list has no subexpression, the only one if
+/// it has one, and the list itself otherwise.
+static Ast* finish_list(Arena* arena, Ast* list) {
+  if (!list->first) {
+    return create_ast(arena, AST_EMPTY);
+  }
+  if (list->first == list->last) {
+    Ast* sub = list->first;
+    remove_sub(list, sub);
+    return sub;
+  }
+  update_nullable(list);
+  return list;
+}
+
+Ast* post2ast(Arena* arena, const char* post) {
+  Ast** stack = malloc(sizeof(Ast*) * (strlen(post) + 1));
+  int top = 0;
+  for (; *post; post++) {
+    switch (*post) {
+      case EXPLICIT_CONCAT:
+      case '|': {
+        if (top < 2) {
+          free(stack);
+          return NULL;
+        }
+        Ast* y = stack[--top];
+        Ast* x = stack[--top];
+        stack[top++] = create_list(
+            arena, *post == '|' ? AST_UNION : AST_CONCAT, x, y);
+      } break;
+      case '*':
+      case '+':
+      case '?': {
+        if (top < 1) {
+          free(stack);
+          return NULL;
+        }
+        const AstKind kind = *post == '*'   ? AST_STAR
+                             : *post == '+' ? AST_PLUS
+                                            : AST_QUEST;
+        stack[top - 1] = create_repetition(arena, kind, stack[top - 1]);
+      } break;
+      case '.':
+        stack[top++] = create_ast(arena, AST_ANY);
+        break;
+      case '[': {
+        ByteSet set;
+        const char* end = parse_byte_set(post, &set);
+        if (!end) {
+          free(stack);
+          return NULL;
+        }
+        post = end - 1;
+        stack[top++] = create_class_ast(arena, &set);
+      } break;
+      default:
+        stack[top++] = create_byte_ast(arena, *post);
+        break;
+    }
+  }
+  Ast* root = top == 1 ? stack[0] : NULL;
+  free(stack);
+  return root;
+}
+
+/// @details Two nested repetitions are the inner one if they are of the same
+/// kind, and a star otherwise, e.g., (a+)? is a*. A plus of a nullable
+/// expression is its star, and a question mark of it is the expression itself.
+static Ast* simplify_repetition(Ast* repetition) {
+  Ast* sub = repetition->first;
+  if (sub->kind == AST_EMPTY) {
+    return sub;
+  }
+  if (is_repetition(sub)) {
+    if (sub->kind != repetition->kind) {
+      sub->kind = AST_STAR;
+      sub->nullable = true;
+    }
+    remove_sub(repetition, sub);
+    return sub;
+  }
+  if (sub->nullable) {
+    if (repetition->kind == AST_QUEST) {
+      remove_sub(repetition, sub);
+      return sub;
+    }
+    repetition->kind = AST_STAR;
+  }
+  update_nullable(repetition);
+  return repetition;
+}
+
+static bool is_any_star(const Ast* ast) {
+  return ast->kind == AST_STAR && ast->first->kind == AST_ANY;
+}
+
+/// @details Since .* matches any string, so does it concatenated with a
+/// nullable expression on either side.
+static Ast* simplify_concat(Arena* arena, Ast* concat) {
+  bool is_absorbing = false;
+  for (Ast* sub = concat->first; sub;) {
+    Ast* next = sub->next;
+    if (sub->kind == AST_EMPTY || (is_absorbing && sub->nullable)) {
+      remove_sub(concat, sub);
+    } else if (is_any_star(sub)) {
+      while (sub->prev && sub->prev->nullable) {
+        remove_sub(concat, sub->prev);
+      }
+      is_absorbing = true;
+    } else {
+      is_absorbing = false;
+    }
+    sub = next;
+  }
+  return finish_list(arena, concat);
+}
+
+typedef enum Direction {
+  FROM_START,
+  FROM_END,
+  /// @brief The alternatives are no longer factored.
+  NOWHERE,
+} Direction;
+
+/// @brief The literal of AST_ANY in the trie, next to those of the bytes.
+enum { ANY_LITERAL = NUM_OF_BYTES };
+
+/// @brief An alternative to factor. The literals of an opaque one are not
+/// looked into, since they have been factored already.
+typedef struct Alternative {
+  Ast* ast;
+  bool is_opaque;
+} Alternative;
+
+/// @brief A growable list of alternatives.
+typedef struct Alternatives {
+  Alternative* alts;
+  int size;
+  int capacity;
+} Alternatives;
+
+static void push_alternative(Alternatives* alts, Ast* ast, bool is_opaque) {
+  if (alts->size == alts->capacity) {
+    alts->capacity = alts->capacity ? alts->capacity * 2 : 8;
+    alts->alts = realloc(alts->alts, sizeof(Alternative) * alts->capacity);
+  }
+  alts->alts[alts->size++] = (Alternative){.ast = ast, .is_opaque = is_opaque};
+}
+
+/// @brief A node of the trie of the literals the alternatives start or end
+/// with, which is reached by the literals from the root.
+typedef struct TrieNode {
+  /// @brief The literal the node is reached by, as returned by literal_of.
+  int literal;
+  int first_child;
+  int last_child;
+  int next_sibling;
+  /// @brief The remainders of the alternatives whose literals end here, which
+  /// are kept in the rests of the trie and linked through their next.
+  int first_rest;
+  int last_rest;
+  /// @brief Whether an alternative has no remainder after the literals.
+  bool has_empty;
+} TrieNode;
+
+typedef struct Rest {
+  Alternative alt;
+  int next;
+} Rest;
+
+/// @note The children of a node are always created after the node, so the
+/// nodes from the last to the first are in post-order.
+typedef struct Trie {
+  TrieNode* nodes;
+  int num_of_nodes;
+  int capacity;
+  Rest* rests;
+  int num_of_rests;
+  int rest_capacity;
+} Trie;
+
+/// @return The byte of AST_BYTE, or ANY_LITERAL for AST_ANY; -1 if the node is
+/// not a literal.
+static int literal_of(const Ast* ast) {
+  if (ast->kind == AST_BYTE) {
+    return ast->byte;
+  }
+  return ast->kind == AST_ANY ? ANY_LITERAL : -1;
+}
+
+static int add_trie_node(Trie* trie, int literal) {
+  if (trie->num_of_nodes == trie->capacity) {
+    trie->capacity *= 2;
+    trie->nodes = realloc(trie->nodes, sizeof(TrieNode) * trie->capacity);
+  }
+  trie->nodes[trie->num_of_nodes] = (TrieNode){.literal = literal,
+                                               .first_child = -1,
+                                               .last_child = -1,
+                                               .next_sibling = -1,
+                                               .first_rest = -1,
+                                               .last_rest = -1,
+                                               .has_empty = false};
+  return trie->num_of_nodes++;
+}
+
+static void init_trie(Trie* trie) {
+  trie->capacity = 16;
+  trie->nodes = malloc(sizeof(TrieNode) * trie->capacity);
+  trie->num_of_nodes = 0;
+  trie->rest_capacity = 16;
+  trie->rests = malloc(sizeof(Rest) * trie->rest_capacity);
+  trie->num_of_rests = 0;
+  add_trie_node(trie, 0);  // the root
+}
+
+static void free_trie(Trie* trie) {
+  free(trie->nodes);
+  free(trie->rests);
+}
+
+/// @return The child of the node on the literal, which is added if not yet.
+static int get_trie_child(Trie* trie, int node, int literal) {
+  for (int child = trie->nodes[node].first_child; child != -1;
+       child = trie->nodes[child].next_sibling) {
+    if (trie->nodes[child].literal == literal) {
+      return child;
+    }
+  }
+  const int child = add_trie_node(trie, literal);
+  TrieNode* parent = &trie->nodes[node];
+  if (parent->last_child == -1) {
+    parent->first_child = child;
+  } else {
+    trie->nodes[parent->last_child].next_sibling = child;
+  }
+  parent->last_child = child;
+  return child;
+}
+
+static void add_trie_rest(Trie* trie, int node, Ast* ast, bool is_opaque) {
+  if (trie->num_of_rests == trie->rest_capacity) {
+    trie->rest_capacity *= 2;
+    trie->rests = realloc(trie->rests, sizeof(Rest) * trie->rest_capacity);
+  }
+  const int rest = trie->num_of_rests++;
+  trie->rests[rest] = (Rest){
+      .alt = {.ast = ast, .is_opaque = is_opaque},
+      .next = -1
+  };
+  TrieNode* n = &trie->nodes[node];
+  if (n->last_rest == -1) {
+    n->first_rest = rest;
+  } else {
+    trie->rests[n->last_rest].next = rest;
+  }
+  n->last_rest = rest;
+}
+
+/// @brief Inserts the literals the alternative starts or ends with into the
+/// trie, and keeps the remainder at the node they lead to.
+static void insert_trie(Trie* trie, Alternative alt, Direction direction) {
+  Ast* ast = alt.ast;
+  if (alt.is_opaque || (literal_of(ast) == -1 && ast->kind != AST_CONCAT)) {
+    add_trie_rest(trie, 0, ast, alt.is_opaque);
+    return;
+  }
+  if (ast->kind != AST_CONCAT) {
+    // the child is found first, since adding it may move the nodes
+    const int child = get_trie_child(trie, 0, literal_of(ast));
+    trie->nodes[child].has_empty = true;
+    return;
+  }
+  const bool from_start = direction == FROM_START;
+  int node = 0;
+  Ast* sub = from_start ? ast->first : ast->last;
+  while (sub && literal_of(sub) != -1) {
+    node = get_trie_child(trie, node, literal_of(sub));
+    sub = from_start ? sub->next : sub->prev;
+  }
+  if (!sub) {
+    trie->nodes[node].has_empty = true;
+    return;
+  }
+  // the literals are cut off the remainder
+  if (node != 0) {
+    if (from_start) {
+      ast->first = sub;
+      sub->prev = NULL;
+    } else {
+      ast->last = sub;
+      sub->next = NULL;
+    }
+    if (ast->first == ast->last) {
+      ast = sub;
+    } else {
+      update_nullable(ast);
+    }
+  }
+  add_trie_rest(trie, node, ast, false);
+}
+
+/// @return The concatenation of the literal and the expression, in the order
+/// of the direction.
+static Ast* join_literal(Arena* arena, int literal, Ast* ast,
+                         Direction direction) {
+  Ast* literal_ast = literal == ANY_LITERAL ? create_ast(arena, AST_ANY)
+                                            : create_byte_ast(arena, literal);
+  if (ast->kind == AST_EMPTY) {
+    return literal_ast;
+  }
+  Ast* concat = ast;
+  if (ast->kind != AST_CONCAT) {
+    concat = create_ast(arena, AST_CONCAT);
+    append_sub(concat, ast);
+  }
+  if (direction == FROM_START) {
+    prepend_sub(concat, literal_ast);
+  } else {
+    append_sub(concat, literal_ast);
+  }
+  concat->nullable = false;
+  return concat;
+}
+
+/// @return The union of the alternatives, where the single bytes and the
+/// classes among them are merged into a single class.
+static Ast* merge_alternatives(Arena* arena, const Alternatives* alts,
+                               bool has_empty) {
+  ByteSet set;
+  clear_byte_set(&set);
+  bool has_any = false;
+  Ast* u = create_ast(arena, AST_UNION);
+  for (int i = 0; i < alts->size; i++) {
+    Ast* ast = alts->alts[i].ast;
+    if (ast->kind == AST_BYTE) {
+      insert_byte_set(&set, ast->byte);
+    } else if (ast->kind == AST_CLASS) {
+      union_byte_set(&set, ast->set);
+    } else if (ast->kind == AST_ANY) {
+      has_any = true;
+    } else if (ast->kind == AST_UNION) {
+      append_subs(u, ast);
+    } else {
+      append_sub(u, ast);
+    }
+  }
+  Ast* byte_class = NULL;
+  if (has_any) {
+    byte_class = create_ast(arena, AST_ANY);
+  } else if (count_byte_set(&set)) {
+    byte_class = create_class_ast(arena, &set);
+  }
+  if (byte_class) {
+    prepend_sub(u, byte_class);
+  }
+  Ast* merged = finish_list(arena, u);
+  if (has_empty && !merged->nullable) {
+    return create_repetition(arena, AST_QUEST, merged);
+  }
+  return merged;
+}
+
+static Ast* factor_alternatives(Arena*, const Alternatives*, bool has_empty,
+                                Direction);
+
+/// @return The union of the alternatives, which is factored further in the
+/// direction.
+static Ast* finish_alternatives(Arena* arena, const Alternatives* alts,
+                                bool has_empty, Direction direction) {
+  if (alts->size == 1 && !has_empty) {
+    return alts->alts[0].ast;
+  }
+  if (alts->size >= 2 && direction != NOWHERE) {
+    return factor_alternatives(arena, alts, has_empty, direction);
+  }
+  return merge_alternatives(arena, alts, has_empty);
+}
+
+/// @details The alternatives which share literals at the end of the direction
+/// share a path of the trie, which is turned back into an expression from the
+/// leaves up. The alternatives under a branch are factored in the other
+/// direction, after which they are merged. An alternative built from a branch
+/// is opaque to that, so each literal is looked into at most once per
+/// direction.
+static Ast* factor_alternatives(Arena* arena, const Alternatives* alts,
+                                bool has_empty, Direction direction) {
+  Trie trie;
+  init_trie(&trie);
+  trie.nodes[0].has_empty = has_empty;
+  for (int i = 0; i < alts->size; i++) {
+    insert_trie(&trie, alts->alts[i], direction);
+  }
+  const Direction next_direction
+      = direction == FROM_END ? FROM_START : NOWHERE;
+  Ast** exprs = malloc(sizeof(Ast*) * trie.num_of_nodes);
+  // whether the node leads to literals only, without any branch
+  bool* is_literal = malloc(sizeof(bool) * trie.num_of_nodes);
+  Alternatives node_alts = {.alts = NULL, .size = 0, .capacity = 0};
+  for (int i = trie.num_of_nodes - 1; i >= 0; i--) {
+    const TrieNode* node = &trie.nodes[i];
+    node_alts.size = 0;
+    for (int child = node->first_child; child != -1;
+         child = trie.nodes[child].next_sibling) {
+      push_alternative(&node_alts,
+                       join_literal(arena, trie.nodes[child].literal,
+                                    exprs[child], direction),
+                       !is_literal[child]);
+    }
+    for (int rest = node->first_rest; rest != -1;
+         rest = trie.rests[rest].next) {
+      push_alternative(&node_alts, trie.rests[rest].alt.ast,
+                       trie.rests[rest].alt.is_opaque);
+    }
+    is_literal[i] = node->first_rest == -1
+                    && (node->first_child == -1
+                            ? node->has_empty
+                            : node->first_child == node->last_child
+                                  && !node->has_empty
+                                  && is_literal[node->first_child]);
+    exprs[i] = node_alts.size
+                   ? finish_alternatives(arena, &node_alts, node->has_empty,
+                                         next_direction)
+                   : create_ast(arena, AST_EMPTY);
+  }
+  Ast* root = exprs[0];
+  free(node_alts.alts);
+  free(is_literal);
+  free(exprs);
+  free_trie(&trie);
+  return root;
+}
+
+static Ast* simplify_union(Arena* arena, Ast* u) {
+  Alternatives alts = {.alts = NULL, .size = 0, .capacity = 0};
+  bool has_empty = false;
+  for (Ast* sub = u->first; sub;) {
+    Ast* next = sub->next;
+    sub->prev = sub->next = NULL;
+    if (sub->kind == AST_EMPTY) {
+      has_empty = true;
+    } else {
+      push_alternative(&alts, sub, false);
+    }
+    sub = next;
+  }
+  Ast* simplified = alts.size ? finish_alternatives(arena, &alts, has_empty,
+                                                    FROM_END)
+                              : create_ast(arena, AST_EMPTY);
+  free(alts.alts);
+  return simplified;
+}
+
+/// @note The subexpressions are simplified already.
+static Ast* simplify_node(Arena* arena, Ast* ast) {
+  switch (ast->kind) {
+    case AST_CONCAT:
+      return simplify_concat(arena, ast);
+    case AST_UNION:
+      return simplify_union(arena, ast);
+    case AST_STAR:
+    case AST_PLUS:
+    case AST_QUEST:
+      return simplify_repetition(ast);
+    default:
+      return ast;
+  }
+}
+
+/// @brief A node being visited, and the subexpression to visit next.
+typedef struct Frame {
+  Ast* node;
+  Ast* sub;
+} Frame;
+
+Ast* simplify_ast(Arena* arena, Ast* root) {
+  int capacity = 16;
+  Frame* frames = malloc(sizeof(Frame) * capacity);
+  int top = 0;
+  frames[top++] = (Frame){.node = root, .sub = root->first};
+  while (true) {
+    Ast* sub = frames[top - 1].sub;
+    if (sub) {
+      if (top == capacity) {
+        capacity *= 2;
+        frames = realloc(frames, sizeof(Frame) * capacity);
+      }
+      frames[top++] = (Frame){.node = sub, .sub = sub->first};
+      continue;
+    }
+    Ast* node = frames[--top].node;
+    Ast* next = node->next;
+    Ast* simplified = simplify_node(arena, node);
+    if (!top) {
+      free(frames);
+      return simplified;
+    }
+    replace_sub(frames[top - 1].node, node, simplified);
+    frames[top - 1].sub = next;
+  }
+}
+
+Ast* strip_any_stars(Arena* arena, Ast* root) {
+  if (root->kind != AST_CONCAT) {
+    return root;
+  }
+  // a simplified concatenation has at most one .* at each end, but a tree
+  // which isn't simplified may have more
+  while (root->first != root->last && is_any_star(root->first)) {
+    remove_sub(root, root->first);
+  }
+  while (root->first != root->last && is_any_star(root->last)) {
+    remove_sub(root, root->last);
+  }
+  return finish_list(arena, root);
+}
+
+/// @brief Takes the run of bytes which starts at first and has len of them as
+/// the literal if it's longer than the best one so far.
+/// @return The length of the literal.
+static size_t take_longer_run(const Ast* first, size_t len, char* literal,
+                              size_t best_len, size_t max_len) {
+  if (len > max_len) {
+    len = max_len;
+  }
+  if (len <= best_len) {
+    return best_len;
+  }
+  for (size_t i = 0; i < len; i++, first = first->next) {
+    literal[i] = (char)first->byte;
+  }
+  return len;
+}
+
+/// @details The nodes every match goes through are visited with an explicit
+/// stack, so deep trees can't overflow the call stack.
+size_t find_required_literal(const Ast* root, char* literal, size_t max_len) {
+  size_t best_len = 0;
+  int capacity = 16;
+  const Ast** stack = malloc(sizeof(Ast*) * capacity);
+  int top = 0;
+  stack[top++] = root;
+  while (top) {
+    const Ast* node = stack[--top];
+    if (node->kind == AST_BYTE) {
+      best_len = take_longer_run(node, 1, literal, best_len, max_len);
+    } else if (node->kind == AST_PLUS || node->kind == AST_CONCAT) {
+      const Ast* run = NULL;
+      size_t run_len = 0;
+      for (const Ast* sub = node->first; sub; sub = sub->next) {
+        if (sub->kind == AST_BYTE) {
+          run = run_len ? run : sub;
+          run_len++;
+          continue;
+        }
+        best_len = take_longer_run(run, run_len, literal, best_len, max_len);
+        run_len = 0;
+        if (sub->kind != AST_PLUS && sub->kind != AST_CONCAT) {
+          continue;
+        }
+        if (top == capacity) {
+          capacity *= 2;
+          stack = realloc(stack, sizeof(Ast*) * capacity);
+        }
+        stack[top++] = sub;
+      }
+      best_len = take_longer_run(run, run_len, literal, best_len, max_len);
+    }
+  }
+  free(stack);
+  return best_len;
+}
+
+/// @brief A growable string.
+typedef struct Buffer {
+  char* chars;
+  size_t size;
+  size_t capacity;
+} Buffer;
+
+static void push_char(Buffer* buf, char c) {
+  if (buf->size == buf->capacity) {
+    buf->capacity *= 2;
+    buf->chars = realloc(buf->chars, buf->capacity);
+  }
+  buf->chars[buf->size++] = c;
+}
+
+static void write_set(Buffer* buf, const ByteSet* set) {
+  char chars[BYTE_SET_MAX_STR_LEN + 1];
+  const size_t len = write_byte_set(set, chars);
+  for (size_t i = 0; i < len; i++) {
+    push_char(buf, chars[i]);
+  }
+}
+
+/// @brief Writes the node itself, which comes after its subexpressions.
+static void write_node(Buffer* buf, const Ast* ast) {
+  switch (ast->kind) {
+    case AST_BYTE:
+      if (is_operator_byte(ast->byte)) {
+        ByteSet set;
+        clear_byte_set(&set);
+        insert_byte_set(&set, ast->byte);
+        write_set(buf, &set);
+      } else {
+        push_char(buf, (char)ast->byte);
+      }
+      break;
+    case AST_ANY:
+      push_char(buf, '.');
+      break;
+    case AST_CLASS:
+      write_set(buf, ast->set);
+      break;
+    case AST_STAR:
+      push_char(buf, '*');
+      break;
+    case AST_PLUS:
+      push_char(buf, '+');
+      break;
+    case AST_QUEST:
+      push_char(buf, '?');
+      break;
+    default:
+      break;  // the empty string, and the lists which have their operators
+              // written between the subexpressions
+  }
+}
+
+/// @details The tree is walked in post-order with an explicit stack, and the
+/// binary operator of a list is written after each subexpression but the
+/// first.
+char* ast2post(const Ast* root) {
+  Buffer buf = {.chars = malloc(16), .size = 0, .capacity = 16};
+  int capacity = 16;
+  Frame* frames = malloc(sizeof(Frame) * capacity);
+  int top = 0;
+  frames[top++] = (Frame){.node = (Ast*)root, .sub = root->first};
+  while (top) {
+    Ast* sub = frames[top - 1].sub;
+    if (sub) {
+      frames[top - 1].sub = sub->next;
+      if (top == capacity) {
+        capacity *= 2;
+        frames = realloc(frames, sizeof(Frame) * capacity);
+      }
+      frames[top++] = (Frame){.node = sub, .sub = sub->first};
+      continue;
+    }
+    const Ast* node = frames[--top].node;
+    write_node(&buf, node);
+    if (top) {
+      const Ast* parent = frames[top - 1].node;
+      if (is_list(parent) && node != parent->first) {
+        push_char(&buf, parent->kind == AST_CONCAT ? EXPLICIT_CONCAT : '|');
+      }
+    }
+  }
+  push_char(&buf, '\0');
+  free(frames);
+  return buf.chars;
+}
+
+static char* simplify(const char* post, bool is_search) {
+  Arena* arena = create_arena();
+  Ast* ast = post2ast(arena, post);
+  if (!ast) {
+    delete_arena(arena);
+    return NULL;
+  }
+  ast = simplify_ast(arena, ast);
+  if (is_search) {
+    ast = strip_any_stars(arena, ast);
+  }
+  char* simplified = ast2post(ast);
+  delete_arena(arena);
+  return simplified;
+}
+
+char* simplify_post(const char* post) {
+  return simplify(post, false);
+}
+
+char* simplify_search_post(const char* post) {
+  return simplify(post, true);
+}
+
+size_t find_post_required_literal(const char* post, char* literal,
+                                  size_t max_len) {
+  Arena* arena = create_arena();
+  Ast* ast = post2ast(arena, post);
+  const size_t len = ast ? find_required_literal(ast, literal, max_len) : 0;
+  delete_arena(arena);
+  return len;
+}
@@ -0,0 +1,109 @@
+#ifndef AST_H
+#define AST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "arena.h"
+#include "byteset.h"
+
+typedef enum AstKind {
+  /// @brief Matches the empty string only.
+  AST_EMPTY,
+  AST_BYTE,
+  AST_ANY,
+  /// @brief Matches a byte of a set of at least two bytes.
+  AST_CLASS,
+  AST_CONCAT,
+  AST_UNION,
+  AST_STAR,
+  AST_PLUS,
+  AST_QUEST,
+} AstKind;
+
+/// @brief A node of the parse tree of a regexp.
+typedef struct Ast {
+  AstKind kind;
+  /// @brief Whether the node matches the empty string.
+  bool nullable;
+  /// @brief The byte of AST_BYTE.
+  unsigned char byte;
+  /// @brief The bytes of AST_CLASS.
+  ByteSet* set;
+  /// @brief The first and the last of the subexpressions, which are linked
+  /// through prev and next. A concatenation or a union has at least two, and a
+  /// repetition has exactly one.
+  struct Ast* first;
+  struct Ast* last;
+  /// @brief The siblings in the list of the parent; NULL if none.
+  struct Ast* prev;
+  struct Ast* next;
+} Ast;
+
+/// @brief Builds the parse tree of the postfix regexp, where nested
+/// concatenations and unions are flattened into a single list each, since
+/// they are associative. A bracket expression of a single byte is that byte,
+/// and one of all the bytes is AST_ANY.
+/// @return The root of the tree; NULL if post is ill-formed.
+/// @note The nodes are allocated from the arena, and are freed along with it.
+Ast* post2ast(Arena*, const char* post);
+
+/// @brief Rewrites the tree into one which matches the same strings with fewer
+/// states:
+/// - nested repetitions are collapsed, e.g., (a*)* and a*+ into a*;
+/// - alternatives which are single bytes are merged into a class, e.g., a|b|c
+/// into [abc];
+/// - common literal prefixes and suffixes are factored out of the
+/// alternatives, e.g., ab|ac into a[bc] and xa|ya into [xy]a, which also
+/// drops duplicate ones;
+/// - .* absorbs its nullable neighbors, e.g., .*a*.* into .*.
+/// @return The root of the rewritten tree, which may reuse the nodes of the
+/// given one. The given tree is no longer valid.
+/// @details The nodes are rewritten bottom-up with an explicit stack, so deep
+/// trees can't overflow the call stack. Factoring goes through a trie of the
+/// literals of the alternatives, which takes time linear in their length.
+Ast* simplify_ast(Arena*, Ast*);
+
+/// @brief Removes the .* at either end of the tree, which a search goes over
+/// anyway since it finds a match anywhere in a string, e.g., .*a.* into a. A
+/// .* on its own is kept, since an empty regexp can't be compiled.
+/// @return The root of the rewritten tree, which may reuse the nodes of the
+/// given one. The given tree is no longer valid.
+Ast* strip_any_stars(Arena*, Ast*);
+
+/// @brief Finds a string of bytes which every string the tree matches
+/// contains, e.g., ERROR: in .*ERROR: (a|b)+.*, so a string without it can be
+/// rejected before any automaton runs. It's the longest run of bytes
+/// concatenated in the tree, looking into the concatenations and the pluses
+/// that every match goes through, but not into the unions and the optional
+/// parts.
+/// @param literal The room for max_len bytes; a longer run is cut, which is
+/// still contained in every match.
+/// @return The length of the literal; 0 if none is found.
+size_t find_required_literal(const Ast*, char* literal, size_t max_len);
+
+/// @return The postfix form of the tree, in the notation of re2post, where a
+/// class is written as a bracket expression, as is a byte which would
+/// otherwise be taken as an operator.
+/// @note Should be freed after use with free.
+char* ast2post(const Ast*);
+
+/// @brief Parses the postfix regexp into a tree, simplifies it with
+/// simplify_ast and writes it back into postfix.
+/// @return The simplified postfix regexp; NULL if post is ill-formed.
+/// @note Should be freed after use with free.
+char* simplify_post(const char* post);
+
+/// @brief Simplifies the postfix regexp as simplify_post does, and also strips
+/// it with strip_any_stars, so it only suits a search.
+/// @return The simplified postfix regexp; NULL if post is ill-formed.
+/// @note Should be freed after use with free.
+char* simplify_search_post(const char* post);
+
+/// @brief Parses the postfix regexp into a tree and finds its literal with
+/// find_required_literal.
+/// @return The length of the literal; 0 if none is found or post is
+/// ill-formed.
+size_t find_post_required_literal(const char* post, char* literal,
+                                  size_t max_len);
+
+#endif /* end of include guard: AST_H */
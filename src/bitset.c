@@ -0,0 +1,170 @@
+#include "bitset.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+enum {
+  BITS_PER_WORD = 64,
+};
+
+static size_t get_size_of_words(int num_of_words) {
+  return sizeof(Bitset) + sizeof(uint64_t) * num_of_words;
+}
+
+static int get_num_of_words(int num_of_bits) {
+  return (num_of_bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+size_t get_bitset_size(int num_of_bits) {
+  return get_size_of_words(get_num_of_words(num_of_bits));
+}
+
+Bitset* init_bitset(void* memory, int num_of_bits) {
+  Bitset* set = memory;
+  set->num_of_words = get_num_of_words(num_of_bits);
+  clear_bitset(set);
+  return set;
+}
+
+Bitset* create_bitset(int num_of_bits) {
+  return init_bitset(malloc(get_bitset_size(num_of_bits)), num_of_bits);
+}
+
+Bitset* copy_bitset(const Bitset* set) {
+  const size_t size = get_size_of_words(set->num_of_words);
+  Bitset* copy = malloc(size);
+  memcpy(copy, set, size);
+  return copy;
+}
+
+void delete_bitset(Bitset* set) {
+  free(set);
+}
+
+size_t get_bitset_memory(const Bitset* set) {
+  return get_size_of_words(set->num_of_words);
+}
+
+void insert_bitset(Bitset* set, int i) {
+  set->words[i / BITS_PER_WORD] |= (uint64_t)1 << (i % BITS_PER_WORD);
+}
+
+bool contains_bitset(const Bitset* set, int i) {
+  return set->words[i / BITS_PER_WORD] >> (i % BITS_PER_WORD) & 1;
+}
+
+void clear_bitset(Bitset* set) {
+  memset(set->words, 0, sizeof(uint64_t) * set->num_of_words);
+}
+
+bool is_empty_bitset(const Bitset* set) {
+  uint64_t any = 0;
+  for (int i = 0; i < set->num_of_words; i++) {
+    any |= set->words[i];
+  }
+  return !any;
+}
+
+// The vector loops handle the leading words and leave the rest to the scalar
+// ones, which start from the word the vector loop stops at.
+
+void union_bitset(Bitset* dst, const Bitset* src) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= dst->num_of_words; i += 4) {
+    __m256i* d = (__m256i*)(dst->words + i);
+    const __m256i s = _mm256_loadu_si256((const __m256i*)(src->words + i));
+    _mm256_storeu_si256(d, _mm256_or_si256(_mm256_loadu_si256(d), s));
+  }
+#elif defined(__SSE2__)
+  for (; i + 2 <= dst->num_of_words; i += 2) {
+    __m128i* d = (__m128i*)(dst->words + i);
+    const __m128i s = _mm_loadu_si128((const __m128i*)(src->words + i));
+    _mm_storeu_si128(d, _mm_or_si128(_mm_loadu_si128(d), s));
+  }
+#endif
+  for (; i < dst->num_of_words; i++) {
+    dst->words[i] |= src->words[i];
+  }
+}
+
+void intersect_bitset(Bitset* dst, const Bitset* a, const Bitset* b) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= dst->num_of_words; i += 4) {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)(a->words + i));
+    const __m256i y = _mm256_loadu_si256((const __m256i*)(b->words + i));
+    _mm256_storeu_si256((__m256i*)(dst->words + i), _mm256_and_si256(x, y));
+  }
+#elif defined(__SSE2__)
+  for (; i + 2 <= dst->num_of_words; i += 2) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)(a->words + i));
+    const __m128i y = _mm_loadu_si128((const __m128i*)(b->words + i));
+    _mm_storeu_si128((__m128i*)(dst->words + i), _mm_and_si128(x, y));
+  }
+#endif
+  for (; i < dst->num_of_words; i++) {
+    dst->words[i] = a->words[i] & b->words[i];
+  }
+}
+
+bool bitset_equal(const Bitset* a, const Bitset* b) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= a->num_of_words; i += 4) {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)(a->words + i));
+    const __m256i y = _mm256_loadu_si256((const __m256i*)(b->words + i));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) != -1) {
+      return false;
+    }
+  }
+#elif defined(__SSE2__)
+  for (; i + 2 <= a->num_of_words; i += 2) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)(a->words + i));
+    const __m128i y = _mm_loadu_si128((const __m128i*)(b->words + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff) {
+      return false;
+    }
+  }
+#endif
+  for (; i < a->num_of_words; i++) {
+    if (a->words[i] != b->words[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @details FNV-1a over the words, folded into 32 bits.
+unsigned hash_bitset(const Bitset* set) {
+  uint64_t hash = 14695981039346656037u;
+  for (int i = 0; i < set->num_of_words; i++) {
+    hash ^= set->words[i];
+    hash *= 1099511628211u;
+  }
+  return (unsigned)(hash ^ hash >> 32);
+}
+
+int next_in_bitset(const Bitset* set, int from) {
+  int i = from / BITS_PER_WORD;
+  if (i >= set->num_of_words) {
+    return -1;
+  }
+  // the bits before from are masked off in the first word
+  uint64_t word = set->words[i] & (~(uint64_t)0 << (from % BITS_PER_WORD));
+  while (!word) {
+    if (++i == set->num_of_words) {
+      return -1;
+    }
+    word = set->words[i];
+  }
+  return i * BITS_PER_WORD + __builtin_ctzll(word);
+}
@@ -0,0 +1,61 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief A fixed-width set of integers from 0 to 64 * num_of_words - 1, one
+/// bit each. Union, intersection and equality work on whole words, with SSE2
+/// or AVX2 if the target supports them.
+/// @note The words are not aligned, so the vector loads and stores are the
+/// unaligned ones.
+typedef struct Bitset {
+  int num_of_words;
+  uint64_t words[];
+} Bitset;
+
+/// @return An empty set which can hold the integers from 0 to
+/// num_of_bits - 1.
+/// @note Should be freed after use with delete_bitset.
+Bitset* create_bitset(int num_of_bits);
+
+/// @return The number of bytes a set of num_of_bits takes.
+size_t get_bitset_size(int num_of_bits);
+
+/// @brief Lays out an empty set in the memory, which has room for
+/// get_bitset_size(num_of_bits) bytes.
+/// @note The memory is owned by the caller, so the set is never deleted.
+Bitset* init_bitset(void* memory, int num_of_bits);
+
+/// @note Should be freed after use with delete_bitset.
+Bitset* copy_bitset(const Bitset*);
+
+void delete_bitset(Bitset*);
+
+/// @return The number of bytes the set takes.
+size_t get_bitset_memory(const Bitset*);
+
+void insert_bitset(Bitset*, int i);
+
+bool contains_bitset(const Bitset*, int i);
+
+void clear_bitset(Bitset*);
+
+bool is_empty_bitset(const Bitset*);
+
+/// @brief Adds the members of src into dst, which have the same width.
+void union_bitset(Bitset* dst, const Bitset* src);
+
+/// @brief Sets dst to the members in both a and b, all of the same width.
+void intersect_bitset(Bitset* dst, const Bitset* a, const Bitset* b);
+
+/// @return Whether the sets of the same width have the same members.
+bool bitset_equal(const Bitset*, const Bitset*);
+
+unsigned hash_bitset(const Bitset*);
+
+/// @return The smallest member which is not less than from; -1 if none.
+int next_in_bitset(const Bitset*, int from);
+
+#endif /* end of include guard: BITSET_H */
@@ -0,0 +1,172 @@
+#include "bitvm.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "bitset.h"
+#include "byteclass.h"
+#include "prog.h"
+#include "scratch.h"
+#include "sparseset.h"
+#include "state.h"
+
+/// @return The important instructions of the set.
+static Bitset* create_important_bitset(const Prog* prog,
+                                       const SparseSet* reached) {
+  Bitset* important = create_bitset(prog->num_of_insts);
+  for (int i = 0; i < reached->size; i++) {
+    if (is_important_inst(&prog->insts[reached->dense[i]])) {
+      insert_bitset(important, reached->dense[i]);
+    }
+  }
+  return important;
+}
+
+BitProg* create_bit_prog(const Prog* prog, const ByteClasses* classes) {
+  const int n = prog->num_of_insts;
+  if (n > BITVM_MAX_INSTS) {
+    return NULL;
+  }
+  BitProg* bit_prog = malloc(sizeof(BitProg));
+  bit_prog->prog = prog;
+  if (classes) {
+    bit_prog->classes = *classes;
+  } else {
+    init_byte_classes(&bit_prog->classes);
+  }
+
+  const int num_of_classes = bit_prog->classes.num_of_classes;
+  bit_prog->takes = malloc(sizeof(Bitset*) * num_of_classes);
+  for (int c = 0; c < num_of_classes; c++) {
+    const char representative = (char)bit_prog->classes.representatives[c];
+    bit_prog->takes[c] = create_bitset(n);
+    for (int i = 0; i < n; i++) {
+      const Inst* inst = &prog->insts[i];
+      if (inst_takes(prog, inst, representative)) {
+        insert_bitset(bit_prog->takes[c], i);
+      }
+    }
+  }
+
+  SparseSet* reached = create_sparse_set(n);
+  int* stack = malloc(sizeof(int) * n);
+  add_initial(prog, reached, stack);
+  bit_prog->start = create_important_bitset(prog, reached);
+  bit_prog->follows = malloc(sizeof(Bitset*) * n);
+  for (int i = 0; i < n; i++) {
+    const Inst* inst = &prog->insts[i];
+    bit_prog->follows[i] = NULL;
+    if (is_important_inst(inst) && inst->label != ACCEPT) {
+      clear_sparse_set(reached);
+      add_follow(prog, i, reached, stack);
+      bit_prog->follows[i] = create_important_bitset(prog, reached);
+    }
+  }
+  free(stack);
+  delete_sparse_set(reached);
+  return bit_prog;
+}
+
+void delete_bit_prog(BitProg* bit_prog) {
+  for (int c = 0; c < bit_prog->classes.num_of_classes; c++) {
+    delete_bitset(bit_prog->takes[c]);
+  }
+  free(bit_prog->takes);
+  for (int i = 0; i < bit_prog->prog->num_of_insts; i++) {
+    if (bit_prog->follows[i]) {
+      delete_bitset(bit_prog->follows[i]);
+    }
+  }
+  free(bit_prog->follows);
+  delete_bitset(bit_prog->start);
+  free(bit_prog);
+}
+
+void step_bit_prog(const BitProg* bit_prog, const Bitset* curr, int class,
+                   Bitset* moved, Bitset* next) {
+  intersect_bitset(moved, curr, bit_prog->takes[class]);
+  clear_bitset(next);
+  for (int i = next_in_bitset(moved, 0); i != -1;
+       i = next_in_bitset(moved, i + 1)) {
+    union_bitset(next, bit_prog->follows[i]);
+  }
+}
+
+size_t get_bit_vm_size(const BitProg* bit_prog) {
+  return get_scratch_size(sizeof(BitVm))
+         + get_scratch_size(get_bitset_size(bit_prog->prog->num_of_insts)) * 3;
+}
+
+BitVm* init_bit_vm(void* memory, BitProg* bit_prog) {
+  const int n = bit_prog->prog->num_of_insts;
+  Scratch scratch;
+  init_scratch(&scratch, memory);
+  BitVm* vm = take_scratch(&scratch, sizeof(BitVm));
+  vm->bit_prog = bit_prog;
+  vm->owns_bit_prog = false;
+  vm->curr = init_bitset(take_scratch(&scratch, get_bitset_size(n)), n);
+  vm->next = init_bitset(take_scratch(&scratch, get_bitset_size(n)), n);
+  vm->moved = init_bitset(take_scratch(&scratch, get_bitset_size(n)), n);
+  return vm;
+}
+
+/// @details The VM and its bitsets take a single allocation.
+BitVm* create_bit_vm(const Prog* prog, const ByteClasses* classes) {
+  BitProg* bit_prog = create_bit_prog(prog, classes);
+  if (!bit_prog) {
+    return NULL;
+  }
+  BitVm* vm = init_bit_vm(malloc(get_bit_vm_size(bit_prog)), bit_prog);
+  vm->owns_bit_prog = true;
+  return vm;
+}
+
+void delete_bit_vm(BitVm* vm) {
+  if (vm->owns_bit_prog) {
+    delete_bit_prog(vm->bit_prog);
+  }
+  free(vm);
+}
+
+bool run_bit_vm(BitVm* vm, const char* s, size_t len) {
+  start_bit_vm(vm);
+  return feed_bit_vm(vm, s, len) && is_bit_vm_accepting(vm);
+}
+
+void start_bit_vm(BitVm* vm) {
+  clear_bitset(vm->curr);
+  union_bitset(vm->curr, vm->bit_prog->start);
+}
+
+/// @details A search stops as soon as the accepting instruction is in the
+/// set, so the rest of the string is never looked at.
+bool feed_bit_vm(BitVm* vm, const char* s, size_t len) {
+  const BitProg* bit_prog = vm->bit_prog;
+  const unsigned char* class_of = bit_prog->classes.class_of;
+  const bool unanchored = bit_prog->prog->unanchored;
+  if (is_empty_bitset(vm->curr)) {
+    return false;
+  }
+  for (const char* end = s + len; s != end; s++) {
+    if (unanchored && is_bit_vm_accepting(vm)) {
+      break;
+    }
+    step_bit_prog(bit_prog, vm->curr, class_of[(unsigned char)*s], vm->moved,
+                  vm->next);
+    if (unanchored) {
+      union_bitset(vm->next, bit_prog->start);
+    }
+    Bitset* tmp = vm->curr;
+    vm->curr = vm->next;
+    vm->next = tmp;
+    if (is_empty_bitset(vm->curr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool is_bit_vm_accepting(const BitVm* vm) {
+  return contains_bitset(vm->curr, vm->bit_prog->prog->accept);
+}
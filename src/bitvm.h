@@ -0,0 +1,89 @@
+#ifndef BITVM_H
+#define BITVM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "bitset.h"
+#include "byteclass.h"
+#include "prog.h"
+
+#ifndef BITVM_MAX_INSTS
+/// @brief Define before including this file if you want to use another cap on
+/// the number of instructions of a program to simulate with bitsets, whose
+/// masks take num_of_insts^2 / 8 bytes.
+#define BITVM_MAX_INSTS 4096
+#endif
+
+/// @brief The transitions of a program as bitsets over its instructions, so a
+/// step is an intersection and a union of bitsets.
+typedef struct BitProg {
+  const Prog* prog;
+  ByteClasses classes;
+  /// @brief The initial instructions.
+  Bitset* start;
+  /// @brief The instructions which take the bytes of each class.
+  Bitset** takes;
+  /// @brief The follow of each labeled instruction; NULL for the others.
+  Bitset** follows;
+} BitProg;
+
+/// @param classes The byte classes of the program; NULL to have each byte be
+/// a class of its own.
+/// @return NULL if the program has more than BITVM_MAX_INSTS instructions.
+/// @note The program has to outlive the masks. Should be freed after use with
+/// delete_bit_prog.
+BitProg* create_bit_prog(const Prog*, const ByteClasses* classes);
+
+void delete_bit_prog(BitProg*);
+
+/// @brief Sets next to the states reached from curr on a byte of the class.
+/// @param moved The room for the states that take the byte.
+void step_bit_prog(const BitProg*, const Bitset* curr, int class,
+                   Bitset* moved, Bitset* next);
+
+/// @brief Simulates a program with its states kept in bitsets.
+typedef struct BitVm {
+  BitProg* bit_prog;
+  /// @brief Whether the masks are owned by the VM.
+  bool owns_bit_prog;
+  Bitset* curr;
+  Bitset* next;
+  Bitset* moved;
+} BitVm;
+
+/// @return NULL if the program has more than BITVM_MAX_INSTS instructions.
+/// @note The program has to outlive the VM. Should be freed after use with
+/// delete_bit_vm.
+BitVm* create_bit_vm(const Prog*, const ByteClasses* classes);
+
+/// @return The number of bytes the VM of the masks takes, bitsets included.
+size_t get_bit_vm_size(const BitProg*);
+
+/// @brief Lays out the VM of the masks in the memory, which has room for
+/// get_bit_vm_size(bit_prog) bytes and is aligned as malloc'd memory is, so
+/// the masks can be shared by VMs in memory of their callers.
+/// @note The masks are not owned by the VM and have to outlive it. The memory
+/// is owned by the caller, so the VM is never deleted.
+BitVm* init_bit_vm(void* memory, BitProg*);
+
+void delete_bit_vm(BitVm*);
+
+/// @return Whether the len bytes of s, which may have any value, null bytes
+/// included, are accepted by the program.
+bool run_bit_vm(BitVm*, const char* s, size_t len);
+
+/// @brief Starts the VM over at the initial states, so a string can be fed to
+/// it in chunks with feed_bit_vm.
+void start_bit_vm(BitVm*);
+
+/// @brief Steps the VM on the len bytes of s, which follow the bytes fed since
+/// the start.
+/// @return Whether any state is left; once none is, no string that starts with
+/// the bytes fed is accepted.
+bool feed_bit_vm(BitVm*, const char* s, size_t len);
+
+/// @return Whether the bytes fed since the start are accepted.
+bool is_bit_vm_accepting(const BitVm*);
+
+#endif /* end of include guard: BITVM_H */
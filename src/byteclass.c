@@ -0,0 +1,65 @@
+#include "byteclass.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "byteset.h"
+#include "prog.h"
+#include "state.h"
+
+void init_byte_classes(ByteClasses* classes) {
+  classes->num_of_classes = NUM_OF_BYTES;
+  for (int b = 0; b < NUM_OF_BYTES; b++) {
+    classes->class_of[b] = b;
+    classes->representatives[b] = b;
+  }
+}
+
+/// @brief Splits each class into the bytes in the set and the bytes not.
+static void refine_byte_classes(ByteClasses* classes, const bool* in_set) {
+  int new_class_of[NUM_OF_BYTES][2];
+  for (int c = 0; c < classes->num_of_classes; c++) {
+    new_class_of[c][false] = new_class_of[c][true] = -1;
+  }
+  int num_of_classes = 0;
+  for (int b = 0; b < NUM_OF_BYTES; b++) {
+    int* new_class = &new_class_of[classes->class_of[b]][in_set[b]];
+    if (*new_class == -1) {
+      *new_class = num_of_classes++;
+      classes->representatives[*new_class] = b;
+    }
+    classes->class_of[b] = *new_class;
+  }
+  classes->num_of_classes = num_of_classes;
+}
+
+/// @details Refines the classes with the label of each instruction. The labels
+/// which take any byte never split a class, and a byte set splits them into
+/// the bytes in the set and the others.
+void compute_byte_classes(const Prog* prog, ByteClasses* classes) {
+  classes->num_of_classes = 1;
+  for (int b = 0; b < NUM_OF_BYTES; b++) {
+    classes->class_of[b] = 0;
+  }
+  classes->representatives[0] = 0;
+
+  bool is_refined_by[NUM_OF_BYTES] = {false};
+  for (int i = 0; i < prog->num_of_insts; i++) {
+    const Inst* inst = &prog->insts[i];
+    const int label = inst->label;
+    if (label < EPSILON && !is_refined_by[(unsigned char)label]) {
+      const unsigned char byte = label;
+      is_refined_by[byte] = true;
+      bool in_set[NUM_OF_BYTES] = {false};
+      in_set[byte] = true;
+      refine_byte_classes(classes, in_set);
+    } else if (label == CLASS) {
+      const ByteSet* set = &get_byte_sets(prog)[inst->set];
+      bool in_set[NUM_OF_BYTES];
+      for (int b = 0; b < NUM_OF_BYTES; b++) {
+        in_set[b] = contains_byte_set(set, b);
+      }
+      refine_byte_classes(classes, in_set);
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#ifndef BYTECLASS_H
+#define BYTECLASS_H
+
+#include <stdbool.h>
+
+#include "byteset.h"
+#include "prog.h"
+
+/// @brief A partition of the bytes into classes, where the bytes of the same
+/// class are never told apart by the NFA. The DFAs then have a transition per
+/// class instead of per byte.
+typedef struct ByteClasses {
+  int num_of_classes;
+  /// @brief The class of each byte.
+  unsigned char class_of[NUM_OF_BYTES];
+  /// @brief A byte of each class, which moves the NFA states the same way as
+  /// the other bytes of the class do.
+  unsigned char representatives[NUM_OF_BYTES];
+} ByteClasses;
+
+/// @brief Puts each byte into a class of its own.
+void init_byte_classes(ByteClasses*);
+
+/// @brief Partitions the bytes by the labels of the instructions in the
+/// program. Two bytes are in the same class if every label takes either both
+/// or none of them.
+void compute_byte_classes(const Prog*, ByteClasses*);
+
+#endif /* end of include guard: BYTECLASS_H */
@@ -0,0 +1,146 @@
+#include "byteset.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum {
+  NUM_OF_WORDS = NUM_OF_BYTES / 64,
+};
+
+void clear_byte_set(ByteSet* set) {
+  memset(set->words, 0, sizeof(set->words));
+}
+
+void insert_byte_set(ByteSet* set, unsigned char b) {
+  set->words[b / 64] |= (uint64_t)1 << (b % 64);
+}
+
+/// @brief Removes the byte from the set.
+static void erase_byte_set(ByteSet* set, unsigned char b) {
+  set->words[b / 64] &= ~((uint64_t)1 << (b % 64));
+}
+
+bool contains_byte_set(const ByteSet* set, unsigned char b) {
+  return (set->words[b / 64] >> (b % 64)) & 1;
+}
+
+void union_byte_set(ByteSet* dst, const ByteSet* src) {
+  for (int i = 0; i < NUM_OF_WORDS; i++) {
+    dst->words[i] |= src->words[i];
+  }
+}
+
+void complement_byte_set(ByteSet* set) {
+  for (int i = 0; i < NUM_OF_WORDS; i++) {
+    set->words[i] = ~set->words[i];
+  }
+}
+
+int count_byte_set(const ByteSet* set) {
+  int count = 0;
+  for (int i = 0; i < NUM_OF_WORDS; i++) {
+    count += __builtin_popcountll(set->words[i]);
+  }
+  return count;
+}
+
+int min_byte_set(const ByteSet* set) {
+  for (int i = 0; i < NUM_OF_WORDS; i++) {
+    if (set->words[i]) {
+      return i * 64 + __builtin_ctzll(set->words[i]);
+    }
+  }
+  return -1;
+}
+
+bool byte_set_equal(const ByteSet* a, const ByteSet* b) {
+  return memcmp(a->words, b->words, sizeof(a->words)) == 0;
+}
+
+const char* parse_byte_set(const char* s, ByteSet* set) {
+  clear_byte_set(set);
+  s++;  // the opening [
+  const bool is_negated = *s == '^';
+  if (is_negated) {
+    s++;
+  }
+  // the first byte is taken as is even if it's a ]
+  for (const char* first = s; *s != ']' || s == first;) {
+    if (!*s) {
+      return NULL;
+    }
+    const unsigned char low = *s++;
+    unsigned char high = low;
+    if (s[0] == '-' && s[1] && s[1] != ']') {
+      high = s[1];
+      s += 2;
+      if (low > high) {
+        return NULL;
+      }
+    }
+    for (int b = low; b <= high; b++) {
+      insert_byte_set(set, b);
+    }
+  }
+  if (is_negated) {
+    complement_byte_set(set);
+  }
+  return s + 1;
+}
+
+/// @details A ] is taken as is only if it comes first and a - only at either
+/// end, so they are written apart from the runs of the other bytes: the ]
+/// first and the - last. A ^ is written after the runs, so it's never first
+/// unless the only other byte is a -, which then goes first instead.
+size_t write_byte_set(const ByteSet* set, char* buf) {
+  ByteSet bytes = *set;
+  char* p = buf;
+  *p++ = '[';
+  if (contains_byte_set(&bytes, '\0')) {
+    complement_byte_set(&bytes);
+    *p++ = '^';
+  }
+  const char* items = p;
+  const bool has_bracket = contains_byte_set(&bytes, ']');
+  bool has_dash = contains_byte_set(&bytes, '-');
+  const bool has_caret = contains_byte_set(&bytes, '^');
+  erase_byte_set(&bytes, ']');
+  erase_byte_set(&bytes, '-');
+  erase_byte_set(&bytes, '^');
+  if (has_bracket) {
+    *p++ = ']';
+  }
+  for (int b = 0; b < NUM_OF_BYTES;) {
+    if (!contains_byte_set(&bytes, b)) {
+      b++;
+      continue;
+    }
+    int end = b;
+    while (end + 1 < NUM_OF_BYTES && contains_byte_set(&bytes, end + 1)) {
+      end++;
+    }
+    *p++ = (char)b;
+    if (end - b >= 2) {
+      *p++ = '-';
+      *p++ = (char)end;
+    } else if (end > b) {
+      *p++ = (char)end;
+    }
+    b = end + 1;
+  }
+  if (has_caret) {
+    if (p == items && has_dash) {
+      *p++ = '-';
+      has_dash = false;
+    }
+    *p++ = '^';
+  }
+  if (has_dash) {
+    *p++ = '-';
+  }
+  *p++ = ']';
+  *p = '\0';
+  return p - buf;
+}
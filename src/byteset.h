@@ -0,0 +1,62 @@
+#ifndef BYTESET_H
+#define BYTESET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum {
+  NUM_OF_BYTES = 256,
+};
+
+/// @brief A set of bytes, one bit each, which is the label of a state that
+/// takes any byte of a bracket expression such as [a-z] or [^0-9].
+typedef struct ByteSet {
+  uint64_t words[NUM_OF_BYTES / 64];
+} ByteSet;
+
+enum {
+  /// @brief The length of the longest bracket expression write_byte_set
+  /// writes, which has each byte at most once besides the brackets and the ^.
+  BYTE_SET_MAX_STR_LEN = NUM_OF_BYTES + 2,
+};
+
+void clear_byte_set(ByteSet*);
+
+void insert_byte_set(ByteSet*, unsigned char);
+
+bool contains_byte_set(const ByteSet*, unsigned char);
+
+/// @brief Adds the bytes of src into dst.
+void union_byte_set(ByteSet* dst, const ByteSet* src);
+
+/// @brief Replaces the bytes of the set with those not in it.
+void complement_byte_set(ByteSet*);
+
+/// @return The number of bytes in the set.
+int count_byte_set(const ByteSet*);
+
+/// @return The smallest byte in the set; -1 if it's empty.
+int min_byte_set(const ByteSet*);
+
+bool byte_set_equal(const ByteSet*, const ByteSet*);
+
+/// @brief Parses the bracket expression which s starts with into the set. A ]
+/// right after the opening [ or [^ is taken as is, as is a - at either end; a
+/// - between two bytes takes the range of them.
+/// @return The end of the bracket expression, which is right after its
+/// closing ]; NULL if it's ill-formed, i.e., unterminated or with a reversed
+/// range.
+const char* parse_byte_set(const char* s, ByteSet*);
+
+/// @brief Writes the bracket expression of the set into buf, which
+/// parse_byte_set parses back into the same set. Runs of at least three bytes
+/// are written as ranges, and a set with the null byte is written as the
+/// complement of the others.
+/// @param buf Room for BYTE_SET_MAX_STR_LEN + 1 bytes.
+/// @return The length of the bracket expression, which is null-terminated.
+/// @note The set should neither be empty, all the bytes, nor the ^ alone,
+/// which have no bracket expression.
+size_t write_byte_set(const ByteSet*, char* buf);
+
+#endif /* end of include guard: BYTESET_H */
@@ -1,63 +1,299 @@
 #include "cache.h"
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include "bitset.h"
+#include "bitvm.h"
+#include "byteclass.h"
 #include "map.h"
-#include "regexp.h"  // get_next_states
+#include "prog.h"
+#include "sparseset.h"
+#include "state.h"
 
-static int state_id = 0;
+/// @return The hash as a key of the map, which has to be non-negative.
+static int bucket_of(unsigned hash) {
+  return (int)(hash & INT_MAX);
+}
 
-DfaState* create_dfa_state(Map* states) {
+DfaState* create_dfa_state(Bitset* states, bool accepting) {
   DfaState* state = malloc(sizeof(DfaState));
-  state->id = state_id++;
+  state->id = NO_CACHE;  // assigned on caching
+  state->accepting = accepting;
+  state->dead = is_empty_bitset(states);
   state->states = states;
-  for (int i = 0; i < 128; i++) {
-    state->next[i] = NO_CACHE;
-  }
+  state->hash = hash_bitset(states);
+  state->next_in_bucket = NULL;
   return state;
 }
 
 void delete_dfa_state(DfaState* dstate) {
-  delete_map(dstate->states);
+  delete_bitset(dstate->states);
   free(dstate);
 }
 
-void cache_dstate(Map* cache_table, DfaState* dstate) {
-  insert_pair(cache_table, dstate->id, dstate);
+/// @return The number of bytes the DFA state takes, including its transitions
+/// in the table.
+static size_t get_dstate_memory(DfaCache* cache, DfaState* dstate) {
+  return sizeof(DfaState) + sizeof(DfaState*)
+         + get_bitset_memory(dstate->states)
+         + sizeof(int) * cache->classes.num_of_classes;
+}
+
+DfaCache* create_dfa_cache(const Prog* prog, const ByteClasses* classes,
+                           size_t budget) {
+  DfaCache* cache = malloc(sizeof(DfaCache));
+  cache->prog = prog;
+  cache->num_of_dstates = 0;
+  cache->capacity = 16;
+  if (classes) {
+    cache->classes = *classes;
+  } else {
+    init_byte_classes(&cache->classes);
+  }
+  cache->dstates = malloc(sizeof(DfaState*) * cache->capacity);
+  cache->table = malloc(sizeof(int) * cache->capacity
+                        * cache->classes.num_of_classes);
+  cache->buckets = create_map();
+  cache->start = NULL;
+  const int num_of_insts = prog ? prog->num_of_insts : 0;
+  cache->bit_prog = prog ? create_bit_prog(prog, &cache->classes) : NULL;
+  cache->reached = create_bitset(num_of_insts);
+  cache->moved = create_bitset(num_of_insts);
+  cache->closure = create_sparse_set(num_of_insts);
+  cache->stack = malloc(sizeof(int) * (num_of_insts ? num_of_insts : 1));
+  cache->budget = budget;
+  cache->memory_used = 0;
+  cache->num_of_flushes = 0;
+  cache->num_of_evictions = 0;
+  cache->sink_id = NO_CACHE;
+  return cache;
+}
+
+void delete_dfa_cache(DfaCache* cache) {
+  for (int i = 0; i < cache->num_of_dstates; i++) {
+    delete_dfa_state(cache->dstates[i]);
+  }
+  free(cache->dstates);
+  free(cache->table);
+  delete_map(cache->buckets);
+  if (cache->bit_prog) {
+    delete_bit_prog(cache->bit_prog);
+  }
+  delete_bitset(cache->reached);
+  delete_bitset(cache->moved);
+  delete_sparse_set(cache->closure);
+  free(cache->stack);
+  free(cache);
+}
+
+void cache_dstate(DfaCache* cache, DfaState* dstate) {
+  const int num_of_classes = cache->classes.num_of_classes;
+  if (cache->num_of_dstates == cache->capacity) {
+    cache->capacity *= 2;
+    cache->dstates
+        = realloc(cache->dstates, sizeof(DfaState*) * cache->capacity);
+    cache->table = realloc(cache->table,
+                           sizeof(int) * cache->capacity * num_of_classes);
+  }
+  dstate->id = cache->num_of_dstates++;
+  cache->dstates[dstate->id] = dstate;
+  if (dstate->dead
+      || (cache->prog && cache->prog->unanchored && dstate->accepting)) {
+    cache->sink_id = dstate->id;
+  }
+  int* next = cache->table + dstate->id * num_of_classes;
+  for (int c = 0; c < num_of_classes; c++) {
+    next[c] = NO_CACHE;
+  }
+
+  const int bucket = bucket_of(dstate->hash);
+  dstate->next_in_bucket = get_value(cache->buckets, bucket);
+  insert_pair(cache->buckets, bucket, dstate);
+  cache->memory_used += get_dstate_memory(cache, dstate);
+}
+
+void flush_dfa_cache(DfaCache* cache, DfaState* dstate) {
+  for (int i = 0; i < cache->num_of_dstates; i++) {
+    DfaState* cached = cache->dstates[i];
+    if (cached != dstate && cached != cache->start) {
+      delete_dfa_state(cached);
+      cache->num_of_evictions++;
+    }
+  }
+  cache->num_of_dstates = 0;
+  cache->sink_id = NO_CACHE;
+  delete_map(cache->buckets);
+  cache->buckets = create_map();
+  cache->memory_used = 0;
+  // the transitions of the kept states are forgotten by re-caching since the
+  // DFA states they go to may be evicted
+  if (cache->start) {
+    cache_dstate(cache, cache->start);
+  }
+  if (dstate && dstate != cache->start) {
+    cache_dstate(cache, dstate);
+  }
+  cache->num_of_flushes++;
+}
+
+DfaState* get_dstate(DfaCache* cache, int id) {
+  if (id < 0 || id >= cache->num_of_dstates) {
+    return NULL;
+  }
+  return cache->dstates[id];
+}
+
+static DfaState* find_dstate_by_hash(DfaCache* cache, const Bitset* states,
+                                     unsigned hash) {
+  for (DfaState* dstate = get_value(cache->buckets, bucket_of(hash)); dstate;
+       dstate = dstate->next_in_bucket) {
+    if (dstate->hash == hash && bitset_equal(dstate->states, states)) {
+      return dstate;
+    }
+  }
+  return NULL;
 }
 
-/// @details Worst case time complexity O(n^2 * m).
-/// m is the capacity of the map, which is the cost of iterating over a map; n
-/// is the size of the map, each search has worst case O(n). Another n for
-/// checking every key.
-static bool map_equal(Map* m1, Map* m2) {
-  if (get_size(m1) != get_size(m2)) {
-    return false;
+DfaState* find_dstate(DfaCache* cache, const Bitset* states) {
+  return find_dstate_by_hash(cache, states, hash_bitset(states));
+}
+
+/// @brief Sets the reached states to the important instructions of the
+/// follows added into the sparse set.
+static void collect_closure(DfaCache* cache) {
+  const Inst* insts = cache->prog->insts;
+  clear_bitset(cache->reached);
+  for (int i = 0; i < cache->closure->size; i++) {
+    const int id = cache->closure->dense[i];
+    if (is_important_inst(&insts[id])) {
+      insert_bitset(cache->reached, id);
+    }
   }
-  FOR_EACH_ITR(m1, itr, {
-    if (!get_value(m2, get_current_key(itr))) {
-      delete_map_iterator(itr);
-      return false;
+}
+
+/// @brief Adds the initial states back into the states reached in a search,
+/// or reduces them to the accepting state once it's reached, since the search
+/// then stops.
+static void restart_search(DfaCache* cache) {
+  if (!cache->prog->unanchored) {
+    return;
+  }
+  if (contains_bitset(cache->reached, cache->prog->accept)) {
+    clear_bitset(cache->reached);
+    insert_bitset(cache->reached, cache->prog->accept);
+  } else if (cache->bit_prog) {
+    union_bitset(cache->reached, cache->bit_prog->start);
+  } else {
+    clear_sparse_set(cache->closure);
+    add_initial(cache->prog, cache->closure, cache->stack);
+    for (int i = 0; i < cache->closure->size; i++) {
+      const int id = cache->closure->dense[i];
+      if (is_important_inst(&cache->prog->insts[id])) {
+        insert_bitset(cache->reached, id);
+      }
     }
-  });
-  return true;
+  }
 }
 
-bool has_cache(Map* cache_table, DfaState* curr_dstate, char c) {
-  if (curr_dstate->next[(int)c] != NO_CACHE) {
-    return true;
+/// @return The DFA state of the states reached, which is built and cached if
+/// it's not yet in the cache. The cache is flushed except for keep if the
+/// budget is exceeded.
+static DfaState* get_reached_dstate(DfaCache* cache, DfaState* keep) {
+  const unsigned hash = hash_bitset(cache->reached);
+  DfaState* dstate = find_dstate_by_hash(cache, cache->reached, hash);
+  if (dstate) {
+    return dstate;
   }
-  bool has_cache = false;
-  Map* next_states = get_next_states(curr_dstate->states, c);
-  FOR_EACH_ITR(cache_table, itr, {
-    DfaState* dstate = get_current_value(itr);
-    if (map_equal(next_states, dstate->states)) {
-      curr_dstate->next[(int)c] = dstate->id;
-      has_cache = true;
+  dstate = create_dfa_state(
+      copy_bitset(cache->reached),
+      contains_bitset(cache->reached, cache->prog->accept));
+  if (cache->budget
+      && cache->memory_used + get_dstate_memory(cache, dstate)
+             > cache->budget) {
+    flush_dfa_cache(cache, keep);
+  }
+  cache_dstate(cache, dstate);
+  return dstate;
+}
+
+DfaState* get_start_dstate(DfaCache* cache) {
+  if (!cache->start) {
+    if (cache->bit_prog) {
+      clear_bitset(cache->reached);
+      union_bitset(cache->reached, cache->bit_prog->start);
+    } else {
+      clear_sparse_set(cache->closure);
+      add_initial(cache->prog, cache->closure, cache->stack);
+      collect_closure(cache);
+    }
+    restart_search(cache);
+    cache->start = get_reached_dstate(cache, NULL);
+  }
+  return cache->start;
+}
+
+/// @details All bytes of a class move the NFA states the same way, so the
+/// next states are computed on the representative of the class. The move is
+/// made on the bitsets if the program is small enough; otherwise it takes
+/// the union of the follows of the states moved from.
+DfaState* get_next_dstate(DfaCache* cache, DfaState* curr_dstate, char c) {
+  const int class = cache->classes.class_of[(unsigned char)c];
+  const int next_id
+      = cache->table[curr_dstate->id * cache->classes.num_of_classes + class];
+  if (next_id != NO_CACHE) {
+    return cache->dstates[next_id];
+  }
+  if (curr_dstate->id == cache->sink_id) {
+    cache->table[curr_dstate->id * cache->classes.num_of_classes + class]
+        = curr_dstate->id;
+    return curr_dstate;
+  }
+  if (cache->bit_prog) {
+    step_bit_prog(cache->bit_prog, curr_dstate->states, class, cache->moved,
+                  cache->reached);
+  } else {
+    const char representative = (char)cache->classes.representatives[class];
+    const Inst* insts = cache->prog->insts;
+    clear_sparse_set(cache->closure);
+    for (int i = next_in_bitset(curr_dstate->states, 0); i != -1;
+         i = next_in_bitset(curr_dstate->states, i + 1)) {
+      const Inst* inst = &insts[i];
+      if (inst_takes(cache->prog, inst, representative)) {
+        add_follow(cache->prog, i, cache->closure, cache->stack);
+      }
+    }
+    collect_closure(cache);
+  }
+  restart_search(cache);
+  DfaState* next_dstate = get_reached_dstate(cache, curr_dstate);
+  // the id of the current DFA state may be changed by the flush
+  cache->table[curr_dstate->id * cache->classes.num_of_classes + class]
+      = next_dstate->id;
+  return next_dstate;
+}
+
+DfaState* feed_dfa_cache(DfaCache* cache, DfaState* curr_dstate, const char* s,
+                         size_t len) {
+  const unsigned char* class_of = cache->classes.class_of;
+  const int num_of_classes = cache->classes.num_of_classes;
+  if (curr_dstate->id == cache->sink_id) {
+    return curr_dstate;
+  }
+  // walks the ids in the table rather than the DFA states
+  int id = curr_dstate->id;
+  for (const char* end = s + len; s != end; s++) {
+    // the table may be moved by the DFA states cached on the way
+    const int next_id
+        = cache->table[id * num_of_classes + class_of[(unsigned char)*s]];
+    // the ids may be changed by a flush, which keeps the current DFA state
+    id = next_id != NO_CACHE
+             ? next_id
+             : get_next_dstate(cache, cache->dstates[id], *s)->id;
+    if (id == cache->sink_id) {
       break;
     }
-  });
-  delete_map(next_states);
-  return has_cache;
+  }
+  return cache->dstates[id];
 }
@@ -1,33 +1,132 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "bitset.h"
+#include "bitvm.h"
+#include "byteclass.h"
 #include "map.h"
+#include "prog.h"
+#include "sparseset.h"
 
 static const int NO_CACHE = -1;
 
-/// @brief A DfaState is a set of NFA state with possible transitions on 128
-/// ASCII characters.
+/// @brief A DfaState is a set of NFA states, which are the important
+/// instructions of a program, kept in a bitset over the instructions. Its
+/// transitions are kept in the table of the cache.
 typedef struct DfaState {
   int id;
-  Map* states;
-  /// @brief The id of the next DFA state on input character; -1 if is not yet
-  /// cached.
-  int next[128];
+  /// @brief Whether the accepting instruction is in the set.
+  bool accepting;
+  /// @brief Whether the set is empty, so no string is accepted from it.
+  bool dead;
+  Bitset* states;
+  unsigned hash;
+  /// @brief The next DFA state which has a set of the same hash.
+  struct DfaState* next_in_bucket;
 } DfaState;
 
-/// @param states The NFA states in this DFA state.
 /// @note The ownership of the states is taken by the DFA state.
-DfaState* create_dfa_state(Map* states);
+DfaState* create_dfa_state(Bitset* states, bool accepting);
 
 /// @note Does not delete the next DFA states.
 void delete_dfa_state(DfaState*);
 
-/// @brief Stores the DFA state to the cache_table.
-void cache_dstate(Map* cache_table, DfaState* dstate);
+/// @brief The DFA states built so far, indexed by their ids and by the hashes
+/// of their sets.
+typedef struct DfaCache {
+  /// @brief The program whose instructions the DFA states consist of; NULL if
+  /// the DFA states are only cached and found but never moved between.
+  const Prog* prog;
+  /// @brief The DFA states indexed by their ids, which are assigned in the
+  /// order of caching, starting from 0.
+  DfaState** dstates;
+  int num_of_dstates;
+  /// @brief The number of DFA states that dstates and table have room for.
+  int capacity;
+  /// @brief The id of the next DFA state of DFA state s on a byte of class c
+  /// is at table[s * classes.num_of_classes + c]; NO_CACHE if not yet cached.
+  int* table;
+  ByteClasses classes;
+  /// @brief Maps a hash to the first DFA state of the bucket.
+  Map* buckets;
+  /// @brief The DFA state to keep on flushes; NULL if none.
+  DfaState* start;
+  /// @brief The id of the DFA state which only moves to itself, so whether a
+  /// string is accepted is settled once it's reached: the dead state, or in a
+  /// search, the accepting one; NO_CACHE if not cached.
+  int sink_id;
+  /// @brief The transitions as bitsets; NULL if the program is too large, in
+  /// which case the follows are added instead.
+  BitProg* bit_prog;
+  /// @brief The states reached by a move, which are looked up in the cache.
+  Bitset* reached;
+  /// @brief The states which take the byte of a move.
+  Bitset* moved;
+  /// @brief The follows are added into the set with the stack.
+  SparseSet* closure;
+  int* stack;
+  /// @brief The maximum number of bytes the DFA states may take; 0 if
+  /// unlimited.
+  size_t budget;
+  /// @brief The number of bytes the DFA states take.
+  size_t memory_used;
+  size_t num_of_flushes;
+  /// @brief The number of DFA states evicted by the flushes.
+  size_t num_of_evictions;
+} DfaCache;
+
+/// @param prog The program to build the DFA of, which has to outlive the
+/// cache; NULL if the DFA states are only cached and found.
+/// @param classes The byte classes of the program; NULL to have each byte be
+/// a class of its own.
+/// @param budget The maximum number of bytes the DFA states may take; 0 if
+/// unlimited. Once a new DFA state exceeds the budget, the cache is flushed.
+DfaCache* create_dfa_cache(const Prog* prog, const ByteClasses* classes,
+                           size_t budget);
+
+/// @brief Deletes the cache and all of the DFA states it holds.
+void delete_dfa_cache(DfaCache*);
+
+/// @brief Stores the DFA state to the cache and assigns an id to it.
+/// @note The ownership of the DFA state is taken by the cache.
+void cache_dstate(DfaCache*, DfaState* dstate);
+
+/// @return The DFA state with id; NULL if not exists.
+DfaState* get_dstate(DfaCache*, int id);
+
+/// @return The DFA state of the initial instructions, which is
+/// built and cached on the first call, and then kept on flushes.
+DfaState* get_start_dstate(DfaCache*);
+
+/// @return The cached DFA state which consists of exactly the states; NULL if
+/// not exists.
+/// @details Takes time linear to the width of the bitset regardless of the
+/// size of the cache.
+DfaState* find_dstate(DfaCache*, const Bitset* states);
+
+/// @brief Evicts all of the DFA states except for the start state and dstate,
+/// which are then given new ids.
+/// @param dstate The DFA state to keep; NULL if none.
+void flush_dfa_cache(DfaCache*, DfaState* dstate);
+
+/// @return The DFA state reached from curr_dstate on byte c. The DFA state is
+/// built and cached if it's not yet in the cache, which flushes the cache
+/// except for curr_dstate if the budget is exceeded. In a search, the initial
+/// states are added to the ones reached, and all the sets with the accepting
+/// state are one DFA state, the sink.
+/// @note This function has side effect on modifing the transition of
+/// curr_dstate on the class of c.
+DfaState* get_next_dstate(DfaCache*, DfaState* curr_dstate, char c);
 
-/// @note This function has side effect on modifing the next states of
-/// curr_dstate on label c, which happens if the next states has a
-/// corresponding DFA state on the cache table.
-bool has_cache(Map* cache_table, DfaState* curr_dstate, char c);
+/// @return The DFA state reached from curr_dstate on the len bytes of s, which
+/// is the sink once whether a string that starts with the bytes is accepted is
+/// settled.
+/// @details The cached transitions are taken in place; only the others go
+/// through get_next_dstate.
+DfaState* feed_dfa_cache(DfaCache*, DfaState* curr_dstate, const char* s,
+                         size_t len);
 
 #endif
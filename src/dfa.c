@@ -0,0 +1,328 @@
+#include "dfa.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "byteclass.h"
+#include "cache.h"
+#include "prog.h"
+
+/// @note The table and the accepting states are not initialized.
+static Dfa* create_dfa(int num_of_states, const ByteClasses* classes) {
+  Dfa* dfa = malloc(sizeof(Dfa));
+  dfa->num_of_states = num_of_states;
+  dfa->start = 0;
+  dfa->dead = -1;
+  dfa->sink = -1;
+  dfa->classes = *classes;
+  dfa->table
+      = malloc(sizeof(int) * classes->num_of_classes * num_of_states);
+  dfa->accepting = malloc(sizeof(bool) * num_of_states);
+  return dfa;
+}
+
+void delete_dfa(Dfa* dfa) {
+  free(dfa->table);
+  free(dfa->accepting);
+  free(dfa);
+}
+
+/// @return A state which only transits to itself and is accepting as given;
+/// -1 if none.
+static int find_sink_state(const Dfa* dfa, bool accepting) {
+  const int num_of_classes = dfa->classes.num_of_classes;
+  for (int s = 0; s < dfa->num_of_states; s++) {
+    if (dfa->accepting[s] != accepting) {
+      continue;
+    }
+    const int* next = dfa->table + s * num_of_classes;
+    int c = 0;
+    while (c < num_of_classes && next[c] == s) {
+      c++;
+    }
+    if (c == num_of_classes) {
+      return s;
+    }
+  }
+  return -1;
+}
+
+static void find_sink_states(Dfa* dfa) {
+  dfa->dead = find_sink_state(dfa, false);
+  dfa->sink = dfa->dead != -1 ? dfa->dead : find_sink_state(dfa, true);
+}
+
+/// @details The cached DFA states are given ids in the order of caching, which
+/// makes the ids indices of the table. The transitions on a class are built
+/// with the cache, which takes the representative of the class.
+Dfa* build_dfa(const Prog* prog, const ByteClasses* classes,
+               size_t max_states) {
+  DfaCache* cache = create_dfa_cache(prog, classes, 0);
+  get_start_dstate(cache);
+  const int num_of_classes = cache->classes.num_of_classes;
+  for (int id = 0; id < cache->num_of_dstates; id++) {
+    for (int c = 0; c < num_of_classes; c++) {
+      get_next_dstate(cache, cache->dstates[id],
+                      (char)cache->classes.representatives[c]);
+      if ((size_t)cache->num_of_dstates > max_states) {
+        delete_dfa_cache(cache);
+        return NULL;
+      }
+    }
+  }
+
+  Dfa* dfa = create_dfa(cache->num_of_dstates, &cache->classes);
+  memcpy(dfa->table, cache->table,
+         sizeof(int) * num_of_classes * dfa->num_of_states);
+  for (int id = 0; id < dfa->num_of_states; id++) {
+    dfa->accepting[id] = cache->dstates[id]->accepting;
+  }
+  find_sink_states(dfa);
+  delete_dfa_cache(cache);
+  return dfa;
+}
+
+/// @brief A partition of the DFA states into blocks, which can be refined in
+/// time proportional to the number of states marked.
+/// @details The states of a block are stored contiguously in elems, from
+/// first[b] to past[b]. The marked states of block b are the first marked[b]
+/// states of the block.
+typedef struct Partition {
+  int num_of_blocks;
+  int* elems;
+  /// @brief The position of each state in elems.
+  int* loc;
+  int* block_of;
+  int* first;
+  int* past;
+  int* marked;
+  /// @brief The blocks which have marked states.
+  int* touched;
+  int num_of_touched;
+} Partition;
+
+static void init_partition(Partition* p, int num_of_states) {
+  p->num_of_blocks = 0;
+  p->elems = malloc(sizeof(int) * num_of_states);
+  p->loc = malloc(sizeof(int) * num_of_states);
+  p->block_of = malloc(sizeof(int) * num_of_states);
+  p->first = malloc(sizeof(int) * num_of_states);
+  p->past = malloc(sizeof(int) * num_of_states);
+  p->marked = calloc(num_of_states, sizeof(int));
+  p->touched = malloc(sizeof(int) * num_of_states);
+  p->num_of_touched = 0;
+}
+
+static void free_partition(Partition* p) {
+  free(p->elems);
+  free(p->loc);
+  free(p->block_of);
+  free(p->first);
+  free(p->past);
+  free(p->marked);
+  free(p->touched);
+}
+
+static int get_block_size(const Partition* p, int b) {
+  return p->past[b] - p->first[b];
+}
+
+/// @brief Moves the state to the marked part of its block.
+static void mark_state(Partition* p, int s) {
+  const int b = p->block_of[s];
+  const int i = p->loc[s];
+  const int j = p->first[b] + p->marked[b];
+  if (i < j) {
+    return;  // already marked
+  }
+  p->elems[i] = p->elems[j];
+  p->loc[p->elems[i]] = i;
+  p->elems[j] = s;
+  p->loc[s] = j;
+  if (p->marked[b]++ == 0) {
+    p->touched[p->num_of_touched++] = b;
+  }
+}
+
+/// @brief A stack of the blocks to split the others with.
+typedef struct Worklist {
+  int* blocks;
+  int size;
+  bool* has_block;
+} Worklist;
+
+static void push_worklist(Worklist* w, int b) {
+  w->blocks[w->size++] = b;
+  w->has_block[b] = true;
+}
+
+/// @brief Splits the touched blocks into their marked and unmarked parts. The
+/// smaller part becomes a new block, so each state is relabeled at most
+/// O(log n) times.
+static void split_touched_blocks(Partition* p, Worklist* w) {
+  while (p->num_of_touched) {
+    const int b = p->touched[--p->num_of_touched];
+    const int mid = p->first[b] + p->marked[b];
+    p->marked[b] = 0;
+    if (mid == p->past[b]) {
+      continue;  // all marked, nothing to split
+    }
+    const int new_block = p->num_of_blocks++;
+    p->marked[new_block] = 0;
+    if (mid - p->first[b] <= p->past[b] - mid) {
+      p->first[new_block] = p->first[b];
+      p->past[new_block] = mid;
+      p->first[b] = mid;
+    } else {
+      p->first[new_block] = mid;
+      p->past[new_block] = p->past[b];
+      p->past[b] = mid;
+    }
+    for (int i = p->first[new_block]; i < p->past[new_block]; i++) {
+      p->block_of[p->elems[i]] = new_block;
+    }
+    // It suffices to split with the smaller one if the block has already been
+    // split with, since splitting with the larger one then gains nothing.
+    if (w->has_block[b]
+        || get_block_size(p, new_block) <= get_block_size(p, b)) {
+      push_worklist(w, new_block);
+    } else {
+      push_worklist(w, b);
+    }
+  }
+}
+
+/// @brief Groups the transitions by class and then by the state they go to, so
+/// the states which go to s on class c are
+/// sources[first[c * (n + 1) + s]] to sources[first[c * (n + 1) + s + 1] - 1].
+typedef struct InverseTable {
+  int* first;
+  int* sources;
+} InverseTable;
+
+static void init_inverse_table(InverseTable* inv, const Dfa* dfa) {
+  const int n = dfa->num_of_states;
+  const int num_of_classes = dfa->classes.num_of_classes;
+  inv->first = calloc((size_t)num_of_classes * (n + 1), sizeof(int));
+  inv->sources = malloc(sizeof(int) * num_of_classes * n);
+  for (int c = 0; c < num_of_classes; c++) {
+    int* first = inv->first + c * (n + 1);
+    for (int s = 0; s < n; s++) {
+      first[dfa->table[s * num_of_classes + c] + 1]++;
+    }
+    first[0] = c * n;
+    for (int t = 0; t < n; t++) {
+      first[t + 1] += first[t];
+    }
+    for (int s = 0; s < n; s++) {
+      const int t = dfa->table[s * num_of_classes + c];
+      inv->sources[first[t]++] = s;
+    }
+    // shift back since first[t] are moved to first[t + 1] by the filling
+    for (int t = n; t > 0; t--) {
+      first[t] = first[t - 1];
+    }
+    first[0] = c * n;
+  }
+}
+
+static void free_inverse_table(InverseTable* inv) {
+  free(inv->first);
+  free(inv->sources);
+}
+
+/// @details The states are first partitioned into the accepting and the
+/// non-accepting ones. A block is then split by each splitter block into the
+/// states which go into the splitter on a class and the states which don't,
+/// until no more block can be split. States in the same block are equivalent.
+Dfa* minimize_dfa(const Dfa* dfa) {
+  const int n = dfa->num_of_states;
+  const int num_of_classes = dfa->classes.num_of_classes;
+  Partition p;
+  init_partition(&p, n);
+  Worklist w = {.blocks = malloc(sizeof(int) * n),
+                .size = 0,
+                .has_block = calloc(n, sizeof(bool))};
+
+  int num_of_accepting = 0;
+  for (int s = 0; s < n; s++) {
+    num_of_accepting += dfa->accepting[s];
+  }
+  int accepting_pos = 0;
+  int non_accepting_pos = num_of_accepting;
+  for (int s = 0; s < n; s++) {
+    const int pos = dfa->accepting[s] ? accepting_pos++ : non_accepting_pos++;
+    p.elems[pos] = s;
+    p.loc[s] = pos;
+  }
+  if (num_of_accepting) {
+    p.first[p.num_of_blocks] = 0;
+    p.past[p.num_of_blocks] = num_of_accepting;
+    push_worklist(&w, p.num_of_blocks++);
+  }
+  if (num_of_accepting != n) {
+    p.first[p.num_of_blocks] = num_of_accepting;
+    p.past[p.num_of_blocks] = n;
+    push_worklist(&w, p.num_of_blocks++);
+  }
+  for (int b = 0; b < p.num_of_blocks; b++) {
+    for (int i = p.first[b]; i < p.past[b]; i++) {
+      p.block_of[p.elems[i]] = b;
+    }
+  }
+
+  InverseTable inv;
+  init_inverse_table(&inv, dfa);
+  // the splitter may be split during the splitting, so copy it out first
+  int* splitter = malloc(sizeof(int) * n);
+  while (w.size) {
+    const int b = w.blocks[--w.size];
+    w.has_block[b] = false;
+    const int splitter_size = get_block_size(&p, b);
+    memcpy(splitter, p.elems + p.first[b], sizeof(int) * splitter_size);
+    for (int c = 0; c < num_of_classes; c++) {
+      const int* first = inv.first + c * (n + 1);
+      for (int i = 0; i < splitter_size; i++) {
+        const int t = splitter[i];
+        for (int j = first[t]; j < first[t + 1]; j++) {
+          mark_state(&p, inv.sources[j]);
+        }
+      }
+      split_touched_blocks(&p, &w);
+    }
+  }
+  free(splitter);
+  free_inverse_table(&inv);
+  free(w.blocks);
+  free(w.has_block);
+
+  Dfa* min_dfa = create_dfa(p.num_of_blocks, &dfa->classes);
+  min_dfa->start = p.block_of[dfa->start];
+  for (int b = 0; b < p.num_of_blocks; b++) {
+    const int representative = p.elems[p.first[b]];
+    min_dfa->accepting[b] = dfa->accepting[representative];
+    for (int c = 0; c < num_of_classes; c++) {
+      min_dfa->table[b * num_of_classes + c]
+          = p.block_of[dfa->table[representative * num_of_classes + c]];
+    }
+  }
+  find_sink_states(min_dfa);
+  free_partition(&p);
+  return min_dfa;
+}
+
+bool is_accepted_by_dfa(const Dfa* dfa, const char* s, size_t len) {
+  return dfa->accepting[feed_dfa(dfa, dfa->start, s, len)];
+}
+
+int feed_dfa(const Dfa* dfa, int state, const char* s, size_t len) {
+  const int* table = dfa->table;
+  const unsigned char* class_of = dfa->classes.class_of;
+  const int num_of_classes = dfa->classes.num_of_classes;
+  const int sink = dfa->sink;
+  for (const char* end = s + len; s != end && state != sink; s++) {
+    state = table[state * num_of_classes + class_of[(unsigned char)*s]];
+  }
+  return state;
+}
@@ -0,0 +1,58 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "byteclass.h"
+#include "prog.h"
+
+#ifndef DFA_MAX_STATES
+/// @brief Define before including this file if you want to use another default
+/// cap on the number of states of a full DFA.
+#define DFA_MAX_STATES 4096
+#endif
+
+/// @brief A fully built DFA, whose transitions are all stored in a table.
+typedef struct Dfa {
+  int num_of_states;
+  int start;
+  /// @brief The state from which no accepting state is reachable; -1 if none.
+  int dead;
+  /// @brief A state which only moves to itself, so whether a string is
+  /// accepted is settled once it's reached: the dead state if any, or else an
+  /// accepting one, such as the one a search stops at; -1 if none.
+  int sink;
+  /// @brief The next state of state s on a byte of class c is at
+  /// table[s * classes.num_of_classes + c].
+  int* table;
+  bool* accepting;
+  ByteClasses classes;
+} Dfa;
+
+/// @brief Builds the DFA of the program with subset construction.
+/// @param classes The byte classes of the program; NULL to have each byte be a
+/// class of its own.
+/// @param max_states The maximum number of states the DFA may have.
+/// @return The DFA; NULL if it has more than max_states states.
+/// @note Should be freed after use with delete_dfa.
+Dfa* build_dfa(const Prog*, const ByteClasses* classes, size_t max_states);
+
+/// @return The equivalent DFA with the minimum number of states.
+/// @details Hopcroft's algorithm, which takes O(k n log n) time for a DFA of n
+/// states over k byte classes.
+/// @note Should be freed after use with delete_dfa.
+Dfa* minimize_dfa(const Dfa*);
+
+void delete_dfa(Dfa*);
+
+/// @return Whether the len bytes of s, which may have any value, null bytes
+/// included, are accepted by the DFA.
+bool is_accepted_by_dfa(const Dfa*, const char* s, size_t len);
+
+/// @brief Moves from the state, starting from the start state, on the len bytes
+/// of s, so a string can be fed in chunks.
+/// @return The state after the bytes, which stays the sink once reached.
+int feed_dfa(const Dfa*, int state, const char* s, size_t len);
+
+#endif /* end of include guard: DFA_H */
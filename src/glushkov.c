@@ -0,0 +1,328 @@
+#include "glushkov.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "byteset.h"
+#include "prog.h"
+#include "re2post.h"
+#include "state.h"
+
+/// @brief A growable list of positions.
+typedef struct Positions {
+  int* ids;
+  int size;
+  int capacity;
+} Positions;
+
+static void init_positions(Positions* positions) {
+  positions->ids = NULL;
+  positions->size = 0;
+  positions->capacity = 0;
+}
+
+static void push_position(Positions* positions, int id) {
+  if (positions->size == positions->capacity) {
+    positions->capacity = positions->capacity ? positions->capacity * 2 : 4;
+    positions->ids
+        = realloc(positions->ids, sizeof(int) * positions->capacity);
+  }
+  positions->ids[positions->size++] = id;
+}
+
+/// @brief A list of positions, whose nodes are linked through a pool so that
+/// two lists are concatenated in constant time.
+typedef struct PositionList {
+  /// @brief The first and the last node; -1 if the list is empty.
+  int head;
+  int tail;
+} PositionList;
+
+/// @brief The nodes of the lists, of which each position has at most two: one
+/// in a list of first positions and one in a list of last positions.
+typedef struct PositionPool {
+  int* ids;
+  int* next;
+  int size;
+} PositionPool;
+
+static PositionList create_position_list(PositionPool* pool, int id) {
+  const int node = pool->size++;
+  pool->ids[node] = id;
+  pool->next[node] = -1;
+  return (PositionList){.head = node, .tail = node};
+}
+
+/// @brief Moves the nodes of the other list to the end of the list.
+static void concat_position_lists(PositionPool* pool, PositionList* to,
+                                  PositionList from) {
+  if (from.head == -1) {
+    return;
+  }
+  if (to->head == -1) {
+    *to = from;
+    return;
+  }
+  pool->next[to->tail] = from.head;
+  to->tail = from.tail;
+}
+
+#define FOR_EACH_POSITION(node, pool, list) \
+  for (int node = (list).head; node != -1; node = (pool)->next[node])
+
+/// @brief The positions a subexpression starts and ends with, and whether it
+/// matches the empty string.
+/// @note The subexpressions on the stack have disjoint positions, so their
+/// lists are merged without checking for duplicates. A list is moved on the
+/// merge, so a node is only ever in one list.
+typedef struct Fragment {
+  bool nullable;
+  PositionList first;
+  PositionList last;
+} Fragment;
+
+static bool is_operator(char c) {
+  return c == EXPLICIT_CONCAT || c == '|' || c == '*' || c == '?' || c == '+';
+}
+
+/// @return The end of the operand which post starts with, which is either a
+/// bracket expression, whose bytes are parsed into the set, or a single byte;
+/// NULL if it's an ill-formed bracket expression.
+static const char* parse_operand(const char* post, ByteSet* set) {
+  if (*post == '[') {
+    return parse_byte_set(post, set);
+  }
+  return post + 1;
+}
+
+/// @brief Adds the first positions of the fragment to the follow of each of
+/// the last positions of the other.
+/// @param num_of_follow_ids The number of positions added to the follows so
+/// far, which is updated.
+/// @return Whether the follows take at most PROG_MAX_FOLLOW_IDS ids; if not,
+/// they're left partly added.
+static bool connect(Positions* follows, const PositionPool* pool,
+                    const Fragment* from, const Fragment* to,
+                    int* num_of_follow_ids) {
+  FOR_EACH_POSITION(i, pool, from->last) {
+    FOR_EACH_POSITION(j, pool, to->first) {
+      if (++*num_of_follow_ids > PROG_MAX_FOLLOW_IDS) {
+        return false;
+      }
+      push_position(&follows[pool->ids[i]], pool->ids[j]);
+    }
+  }
+  return true;
+}
+
+/// @brief Computes the nullability and the first and last positions of each
+/// subexpression with a stack, along with the follows of the positions.
+/// @return Whether post is well-formed and its follows take at most
+/// PROG_MAX_FOLLOW_IDS ids; the result is then the fragment of the whole
+/// regexp, whose lists are in the pool.
+/// @details Apart from the follows, which are the output, each operator takes
+/// constant time, so this is linear in the length of post. The follows may
+/// still be quadratic in it, e.g., for a starred union, hence the cap.
+static bool compute_positions(const char* post, Positions* follows,
+                              PositionPool* pool, Fragment* result) {
+  const int len = strlen(post);
+  Fragment* stack = malloc(sizeof(Fragment) * (len ? len : 1));
+  int top = 0;
+  int num_of_positions = 0;
+  int num_of_follow_ids = 0;
+  bool is_well_formed = true;
+  for (; *post && is_well_formed; post++) {
+    switch (*post) {
+      case EXPLICIT_CONCAT: {
+        if (top < 2) {
+          is_well_formed = false;
+          break;
+        }
+        const Fragment f2 = stack[--top];
+        Fragment* f1 = &stack[top - 1];
+        if (!connect(follows, pool, f1, &f2, &num_of_follow_ids)) {
+          is_well_formed = false;
+          break;
+        }
+        if (f1->nullable) {
+          concat_position_lists(pool, &f1->first, f2.first);
+        }
+        PositionList last = f2.last;
+        if (f2.nullable) {
+          concat_position_lists(pool, &last, f1->last);
+        }
+        f1->last = last;
+        f1->nullable = f1->nullable && f2.nullable;
+      } break;
+      case '|': {
+        if (top < 2) {
+          is_well_formed = false;
+          break;
+        }
+        const Fragment f2 = stack[--top];
+        Fragment* f1 = &stack[top - 1];
+        concat_position_lists(pool, &f1->first, f2.first);
+        concat_position_lists(pool, &f1->last, f2.last);
+        f1->nullable = f1->nullable || f2.nullable;
+      } break;
+      case '*':
+      case '+':
+      case '?': {
+        if (top < 1) {
+          is_well_formed = false;
+          break;
+        }
+        Fragment* f = &stack[top - 1];
+        if (*post != '?' && !connect(follows, pool, f, f, &num_of_follow_ids)) {
+          is_well_formed = false;
+          break;
+        }
+        if (*post != '+') {
+          f->nullable = true;
+        }
+      } break;
+      default: {
+        Fragment* f = &stack[top++];
+        f->nullable = false;
+        f->first = create_position_list(pool, num_of_positions);
+        f->last = create_position_list(pool, num_of_positions);
+        num_of_positions++;
+        ByteSet set;
+        post = parse_operand(post, &set) - 1;
+      } break;
+    }
+  }
+  if (top != 1) {
+    is_well_formed = false;
+  }
+  if (is_well_formed) {
+    *result = stack[0];
+  }
+  free(stack);
+  return is_well_formed;
+}
+
+/// @details The positions are numbered in the order they occur in, which are
+/// the ids of their instructions, and the accepting instruction comes last.
+/// A star may add the same positions to a follow more than once, so the
+/// follows are deduplicated on the copying into the program.
+Prog* post2glushkov(const char* post) {
+  int num_of_positions = 0;
+  int num_of_sets = 0;
+  for (const char* p = post; *p;) {
+    if (is_operator(*p)) {
+      p++;
+      continue;
+    }
+    num_of_positions++;
+    num_of_sets += *p == '[';
+    ByteSet set;
+    p = parse_operand(p, &set);
+    if (!p) {
+      return NULL;
+    }
+  }
+  Positions* follows = malloc(sizeof(Positions) * (num_of_positions + 1));
+  for (int i = 0; i < num_of_positions; i++) {
+    init_positions(&follows[i]);
+  }
+  // a node of each list a position starts in, and one more for the accepting
+  // instruction to be an initial one
+  PositionPool pool = {.ids = malloc(sizeof(int) * (num_of_positions * 2 + 1)),
+                       .next = malloc(sizeof(int) * (num_of_positions * 2 + 1)),
+                       .size = 0};
+  Fragment regexp;
+  if (!compute_positions(post, follows, &pool, &regexp)) {
+    for (int i = 0; i < num_of_positions; i++) {
+      free(follows[i].ids);
+    }
+    free(follows);
+    free(pool.ids);
+    free(pool.next);
+    return NULL;
+  }
+  const int accept = num_of_positions;
+  FOR_EACH_POSITION(i, &pool, regexp.last) {
+    push_position(&follows[pool.ids[i]], accept);
+  }
+  if (regexp.nullable) {
+    concat_position_lists(&pool, &regexp.first,
+                          create_position_list(&pool, accept));
+  }
+
+  int num_of_follow_ids = 0;
+  FOR_EACH_POSITION(i, &pool, regexp.first) {
+    num_of_follow_ids++;
+  }
+  for (int i = 0; i < num_of_positions; i++) {
+    num_of_follow_ids += follows[i].size;
+  }
+  Prog* prog
+      = allocate_prog(num_of_positions + 1, num_of_sets, num_of_follow_ids);
+  prog->start = -1;
+  prog->accept = accept;
+  int* follow_ids = (int*)get_follow_ids(prog);
+  int size = 0;
+  prog->initial_begin = size;
+  FOR_EACH_POSITION(i, &pool, regexp.first) {
+    follow_ids[size++] = pool.ids[i];
+  }
+  prog->initial_end = size;
+
+  // the last position whose follow each position is copied into; -1 if none
+  int* copied_into = malloc(sizeof(int) * (num_of_positions + 1));
+  for (int i = 0; i <= num_of_positions; i++) {
+    copied_into[i] = -1;
+  }
+  ByteSet* sets = (ByteSet*)get_byte_sets(prog);
+  int num_of_sets_parsed = 0;
+  for (int i = 0; i < num_of_positions; i++) {
+    while (is_operator(*post)) {
+      post++;
+    }
+    Inst* inst = &prog->insts[i];
+    if (*post == '[') {
+      inst->label = CLASS;
+      inst->set = num_of_sets_parsed++;
+      post = parse_byte_set(post, &sets[inst->set]);
+    } else {
+      inst->label = *post == '.' ? ANY : (unsigned char)*post;
+      inst->set = -1;
+      post++;
+    }
+    inst->outs[0] = inst->outs[1] = -1;
+    inst->follow_begin = size;
+    for (int j = 0; j < follows[i].size; j++) {
+      const int id = follows[i].ids[j];
+      if (copied_into[id] != i) {
+        copied_into[id] = i;
+        follow_ids[size++] = id;
+      }
+    }
+    inst->follow_end = size;
+    free(follows[i].ids);
+  }
+  Inst* accept_inst = &prog->insts[accept];
+  accept_inst->label = ACCEPT;
+  accept_inst->set = -1;
+  accept_inst->outs[0] = accept_inst->outs[1] = -1;
+  accept_inst->follow_begin = accept_inst->follow_end = -1;
+  prog->num_of_follow_ids = size;
+
+  free(copied_into);
+  free(follows);
+  free(pool.ids);
+  free(pool.next);
+  return prog;
+}
+
+Prog* re2glushkov(const char* re) {
+  char* post = re2post(re);
+  if (!post) {
+    return NULL;
+  }
+  Prog* prog = post2glushkov(post);
+  free(post);
+  return prog;
+}
@@ -0,0 +1,24 @@
+#ifndef GLUSHKOV_H
+#define GLUSHKOV_H
+
+#include "prog.h"
+#include "re2post.h"
+
+/// @brief Builds the position automaton of the postfix regexp with Glushkov's
+/// construction, which has no epsilon transitions and exactly one labeled
+/// instruction per symbol occurrence, plus the accepting instruction.
+/// @return The program, which has no start instruction but its initial
+/// instructions and follows all precomputed; NULL if post is ill-formed or the
+/// follows would take more than PROG_MAX_FOLLOW_IDS ids, which a starred
+/// union of many alternatives does since they follow each other.
+/// @note Should be freed after use with delete_prog.
+Prog* post2glushkov(const char* post);
+
+/// @brief Converts the infix regexp to postfix with re2post and then builds
+/// its position automaton with post2glushkov.
+/// @return The program; NULL if re is ill-formed or its follows are too
+/// large, in the same way as post2glushkov.
+/// @note Should be freed after use with delete_prog.
+Prog* re2glushkov(const char* re);
+
+#endif /* end of include guard: GLUSHKOV_H */
@@ -0,0 +1,312 @@
+#include "grep.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "literal.h"
+#include "regexp.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The vector loop handles the leading bytes and leaves the rest to the scalar
+// one, which starts from the byte the vector loop stops at.
+
+const char* find_newline(const char* s, const char* end) {
+#if defined(__AVX2__)
+  const __m256i newlines = _mm256_set1_epi8('\n');
+  for (; end - s >= 32; s += 32) {
+    const __m256i bytes = _mm256_loadu_si256((const __m256i*)s);
+    const uint32_t mask
+        = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newlines));
+    if (mask) {
+      return s + __builtin_ctz(mask);
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i newlines = _mm_set1_epi8('\n');
+  for (; end - s >= 16; s += 16) {
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)s);
+    const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newlines));
+    if (mask) {
+      return s + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; s != end; s++) {
+    if (*s == '\n') {
+      return s;
+    }
+  }
+  return end;
+}
+
+/// @return The beginning of the first line from line to end which contains
+/// the literal of the regexp, since only such a line may be matched; end if
+/// none. Every line may be matched if the regexp has no literal.
+static const char* find_candidate_line(const Regexp* regexp, const char* line,
+                                       const char* end) {
+  size_t literal_len;
+  const char* literal = get_regexp_literal(regexp, &literal_len);
+  const char* hit = find_literal(line, end, literal, literal_len);
+  if (hit == end) {
+    return end;
+  }
+  while (hit != line && hit[-1] != '\n') {
+    hit--;
+  }
+  return hit;
+}
+
+/// @details The lines without the literal of the regexp are skipped as it's
+/// looked for, so the automata only run on the lines around its occurrences.
+size_t grep_lines(Regexp* regexp, const char* buf, size_t len,
+                  OnLineMatched on_matched, void* data) {
+  size_t num_of_matched = 0;
+  const char* end = buf + len;
+  const char* line = buf;
+  while ((line = find_candidate_line(regexp, line, end)) != end) {
+    const char* line_end = find_newline(line, end);
+    if (match_regexp_n(regexp, line, line_end - line)) {
+      num_of_matched++;
+      if (on_matched && !on_matched(line, line_end - line, data)) {
+        break;
+      }
+    }
+    line = line_end == end ? end : line_end + 1;
+  }
+  return num_of_matched;
+}
+
+enum {
+  /// @brief The number of bytes a chunk of lines has at least, unless it's the
+  /// last one. A chunk is the unit of work a thread takes at a time.
+  GREP_CHUNK_SIZE = 1 << 20,
+  /// @brief The number of chunks each thread may take ahead of the ones whose
+  /// lines are passed to on_matched, which bounds the lines matched kept.
+  GREP_CHUNKS_AHEAD_PER_THREAD = 4,
+};
+
+typedef struct GrepLine {
+  const char* line;
+  size_t len;
+} GrepLine;
+
+/// @brief The lines from begin to end, which end at a newline unless end is
+/// the end of the buffer.
+typedef struct GrepChunk {
+  const char* begin;
+  const char* end;
+  /// @brief The lines matched, which are kept only if they are passed to
+  /// on_matched; NULL if none.
+  GrepLine* lines;
+  size_t num_of_matched;
+  size_t capacity;
+  /// @brief Whether all the lines are matched.
+  bool done;
+} GrepChunk;
+
+/// @brief The state shared by the threads, which is guarded by the mutex.
+typedef struct ParallelGrep {
+  const Regexp* regexp;
+  GrepChunk* chunks;
+  size_t num_of_chunks;
+  /// @brief The index of the next chunk to be taken.
+  size_t next;
+  /// @brief The number of chunks whose lines are passed to on_matched.
+  size_t num_of_reported;
+  /// @brief The number of chunks that may be taken but not yet reported.
+  size_t max_ahead;
+  /// @brief Whether the lines matched are kept.
+  bool keeps_lines;
+  /// @brief Whether on_matched stops, after which no chunk is taken.
+  bool stops;
+  pthread_mutex_t mutex;
+  /// @brief Signaled once a chunk is done or reported.
+  pthread_cond_t changed;
+} ParallelGrep;
+
+static void keep_line(GrepChunk* chunk, const char* line, size_t len) {
+  if (chunk->num_of_matched == chunk->capacity) {
+    chunk->capacity = chunk->capacity ? chunk->capacity * 2 : 16;
+    chunk->lines = realloc(chunk->lines, chunk->capacity * sizeof(GrepLine));
+  }
+  chunk->lines[chunk->num_of_matched] = (GrepLine){line, len};
+}
+
+static void grep_chunk(const ParallelGrep* grep, RegexpMatcher* matcher,
+                       GrepChunk* chunk) {
+  const char* line = chunk->begin;
+  while ((line = find_candidate_line(grep->regexp, line, chunk->end))
+         != chunk->end) {
+    const char* line_end = find_newline(line, chunk->end);
+    if (match_regexp_with_matcher(matcher, line, line_end - line)) {
+      if (grep->keeps_lines) {
+        keep_line(chunk, line, line_end - line);
+      }
+      chunk->num_of_matched++;
+    }
+    line = line_end == chunk->end ? chunk->end : line_end + 1;
+  }
+}
+
+/// @brief Takes the chunks one at a time until there's none left or
+/// on_matched stops.
+static void* grep_chunks(void* arg) {
+  ParallelGrep* grep = arg;
+  RegexpMatcher* matcher = create_regexp_matcher(grep->regexp);
+  pthread_mutex_lock(&grep->mutex);
+  while (true) {
+    while (!grep->stops && grep->next != grep->num_of_chunks
+           && grep->next - grep->num_of_reported >= grep->max_ahead) {
+      pthread_cond_wait(&grep->changed, &grep->mutex);
+    }
+    if (grep->stops || grep->next == grep->num_of_chunks) {
+      break;
+    }
+    GrepChunk* chunk = &grep->chunks[grep->next++];
+    pthread_mutex_unlock(&grep->mutex);
+    grep_chunk(grep, matcher, chunk);
+    pthread_mutex_lock(&grep->mutex);
+    chunk->done = true;
+    pthread_cond_broadcast(&grep->changed);
+  }
+  pthread_mutex_unlock(&grep->mutex);
+  delete_regexp_matcher(matcher);
+  return NULL;
+}
+
+/// @brief Splits the bytes into chunks of at least GREP_CHUNK_SIZE bytes,
+/// each extended to the end of its last line.
+/// @return The number of chunks.
+static size_t split_into_chunks(const char* buf, size_t len,
+                                GrepChunk* chunks) {
+  size_t num_of_chunks = 0;
+  const char* end = buf + len;
+  for (const char* begin = buf; begin != end;) {
+    const char* chunk_end = end;
+    if ((size_t)(end - begin) > GREP_CHUNK_SIZE) {
+      chunk_end = find_newline(begin + GREP_CHUNK_SIZE - 1, end);
+      if (chunk_end != end) {
+        chunk_end++;
+      }
+    }
+    chunks[num_of_chunks++] = (GrepChunk){.begin = begin, .end = chunk_end};
+    begin = chunk_end;
+  }
+  return num_of_chunks;
+}
+
+size_t grep_lines_in_parallel(const Regexp* regexp, const char* buf,
+                              size_t len, int num_of_threads,
+                              OnLineMatched on_matched, void* data) {
+  // each chunk but the last has at least GREP_CHUNK_SIZE bytes
+  GrepChunk* chunks = malloc((len / GREP_CHUNK_SIZE + 1) * sizeof(GrepChunk));
+  ParallelGrep grep = {
+      .regexp = regexp,
+      .chunks = chunks,
+      .num_of_chunks = split_into_chunks(buf, len, chunks),
+      .max_ahead = (size_t)num_of_threads * GREP_CHUNKS_AHEAD_PER_THREAD,
+      .keeps_lines = on_matched != NULL,
+  };
+  pthread_mutex_init(&grep.mutex, NULL);
+  pthread_cond_init(&grep.changed, NULL);
+  pthread_t* threads = malloc(num_of_threads * sizeof(pthread_t));
+  int num_of_started = 0;
+  while (num_of_started < num_of_threads
+         && pthread_create(&threads[num_of_started], NULL, grep_chunks, &grep)
+                == 0) {
+    num_of_started++;
+  }
+  if (!num_of_started) {
+    // matches all the chunks ahead of reporting them if no thread can start
+    grep.max_ahead = grep.num_of_chunks;
+    grep_chunks(&grep);
+  }
+
+  // the lines matched are passed in the order of the chunks
+  size_t num_of_matched = 0;
+  for (size_t i = 0; i < grep.num_of_chunks && !grep.stops; i++) {
+    GrepChunk* chunk = &chunks[i];
+    pthread_mutex_lock(&grep.mutex);
+    while (!chunk->done) {
+      pthread_cond_wait(&grep.changed, &grep.mutex);
+    }
+    pthread_mutex_unlock(&grep.mutex);
+    bool stops = false;
+    if (on_matched) {
+      for (size_t j = 0; j < chunk->num_of_matched && !stops; j++) {
+        num_of_matched++;
+        stops = !on_matched(chunk->lines[j].line, chunk->lines[j].len, data);
+      }
+    } else {
+      num_of_matched += chunk->num_of_matched;
+    }
+    pthread_mutex_lock(&grep.mutex);
+    grep.num_of_reported++;
+    grep.stops = stops;
+    pthread_cond_broadcast(&grep.changed);
+    pthread_mutex_unlock(&grep.mutex);
+  }
+
+  for (int i = 0; i < num_of_started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  for (size_t i = 0; i < grep.num_of_chunks; i++) {
+    free(chunks[i].lines);
+  }
+  free(threads);
+  pthread_cond_destroy(&grep.changed);
+  pthread_mutex_destroy(&grep.mutex);
+  free(chunks);
+  return num_of_matched;
+}
+
+bool map_file(const char* path, MappedFile* file) {
+  // doesn't wait for a writer if it's a pipe, which is then refused
+  const int fd = open(path, O_RDONLY | O_NONBLOCK);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    return false;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    close(fd);
+    errno = S_ISDIR(st.st_mode) ? EISDIR : ENODEV;
+    return false;
+  }
+  file->size = st.st_size;
+  file->data = NULL;
+  if (file->size) {
+    void* data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+    madvise(data, file->size, MADV_SEQUENTIAL);
+    file->data = data;
+  }
+  // the mapping stays valid after the file is closed
+  close(fd);
+  return true;
+}
+
+void unmap_file(MappedFile* file) {
+  if (file->data) {
+    munmap((void*)file->data, file->size);
+  }
+}
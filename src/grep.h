@@ -0,0 +1,60 @@
+#ifndef GREP_H
+#define GREP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "regexp.h"
+
+/// @return The first newline in the bytes from s to end; end if none.
+/// @details Compares a vector of bytes at a time with SSE2, or AVX2 if
+/// enabled.
+const char* find_newline(const char* s, const char* end);
+
+/// @brief Called with each line matched, which is len bytes from line without
+/// its newline, and the data given to grep_lines.
+/// @return Whether to go on to the next lines.
+typedef bool (*OnLineMatched)(const char* line, size_t len, void* data);
+
+/// @brief Matches each line of the len bytes of buf with the regexp, which
+/// has to match the whole line. A line ends at a newline or the end of buf,
+/// so a last line without a newline is a line too, but a newline at the end
+/// of buf doesn't start an empty one.
+/// @param on_matched NULL if only the lines matched are counted.
+/// @return The number of lines matched, up to where on_matched stops.
+/// @note The regexp is matched with match_regexp_n, so its DFA cache, if any,
+/// persists across the lines.
+size_t grep_lines(Regexp*, const char* buf, size_t len,
+                  OnLineMatched on_matched, void* data);
+
+/// @brief Matches each line of the len bytes of buf as grep_lines does, but
+/// with the threads. The bytes are split into chunks of whole lines, which the
+/// threads take one at a time as they become free, each matching with a
+/// matcher of its own, so the regexp is only read. The lines matched are
+/// still passed to on_matched in order, from the calling thread.
+/// @param num_of_threads The number of threads to start, which is at least 1.
+/// @return The number of lines matched, up to where on_matched stops.
+/// @note The lines matched are kept until all the lines before them are
+/// passed, so the threads run only a few chunks ahead of on_matched.
+size_t grep_lines_in_parallel(const Regexp*, const char* buf, size_t len,
+                              int num_of_threads, OnLineMatched on_matched,
+                              void* data);
+
+/// @brief A file mapped into memory as read-only.
+typedef struct MappedFile {
+  /// @brief NULL if the file is empty, which has nothing to map.
+  const char* data;
+  size_t size;
+} MappedFile;
+
+/// @brief Maps the whole file at the path into memory, which is read
+/// sequentially.
+/// @return Whether the file is mapped; false if it can't be opened or mapped,
+/// which has errno set: EISDIR for a directory and ENODEV for another file
+/// that isn't regular, e.g., a pipe.
+/// @note Should be unmapped after use with unmap_file.
+bool map_file(const char* path, MappedFile*);
+
+void unmap_file(MappedFile*);
+
+#endif /* end of include guard: GREP_H */
@@ -0,0 +1,60 @@
+#include "literal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const char* find_literal(const char* s, const char* end, const char* literal,
+                         size_t len) {
+  if (!len) {
+    return s;
+  }
+  if ((size_t)(end - s) < len) {
+    return end;
+  }
+#if defined(__AVX2__)
+  const __m256i first = _mm256_set1_epi8(literal[0]);
+  const __m256i last = _mm256_set1_epi8(literal[len - 1]);
+  // both loads have to be within the bytes
+  for (; (size_t)(end - s) >= len + 31; s += 32) {
+    const __m256i heads = _mm256_loadu_si256((const __m256i*)s);
+    const __m256i tails = _mm256_loadu_si256((const __m256i*)(s + len - 1));
+    uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(heads, first), _mm256_cmpeq_epi8(tails, last)));
+    for (; mask; mask &= mask - 1) {
+      const char* candidate = s + __builtin_ctz(mask);
+      if (memcmp(candidate, literal, len) == 0) {
+        return candidate;
+      }
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i first = _mm_set1_epi8(literal[0]);
+  const __m128i last = _mm_set1_epi8(literal[len - 1]);
+  // both loads have to be within the bytes
+  for (; (size_t)(end - s) >= len + 15; s += 16) {
+    const __m128i heads = _mm_loadu_si128((const __m128i*)s);
+    const __m128i tails = _mm_loadu_si128((const __m128i*)(s + len - 1));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(heads, first), _mm_cmpeq_epi8(tails, last)));
+    for (; mask; mask &= mask - 1) {
+      const char* candidate = s + __builtin_ctz(mask);
+      if (memcmp(candidate, literal, len) == 0) {
+        return candidate;
+      }
+    }
+  }
+#endif
+  for (; (size_t)(end - s) >= len; s++) {
+    if (*s == literal[0] && memcmp(s, literal, len) == 0) {
+      return s;
+    }
+  }
+  return end;
+}
@@ -0,0 +1,16 @@
+#ifndef LITERAL_H
+#define LITERAL_H
+
+#include <stddef.h>
+
+/// @return The first occurrence of the len bytes of literal in the bytes from
+/// s to end; end if none. An empty literal occurs at s.
+/// @details Compares a vector of the bytes an occurrence may start at with the
+/// first byte of the literal and another, shifted by len - 1, with the last
+/// one, with SSE2, or AVX2 if enabled, so only the positions where both agree
+/// are compared in full. A rare literal is thus found at about the speed of
+/// memchr.
+const char* find_literal(const char* s, const char* end, const char* literal,
+                         size_t len);
+
+#endif /* end of include guard: LITERAL_H */
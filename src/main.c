@@ -7,60 +7,233 @@ The full text of the license can be found in
 https://opensource.org/license/mit/.
  */
 
+#include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "args.h"
 #include "colors.h"
+#include "grep.h"
 #include "regexp.h"
 #include "visstate.h"
 
+enum {
+  /// @brief The number of bytes read from the input file at a time.
+  INPUT_CHUNK_SIZE = 1 << 16,
+};
+
+/// @return Whether the whole content of the file is accepted by the regexp.
+/// @note The file is read in chunks, so it takes constant memory.
+/// @note A read error ends the input early; check ferror() afterwards.
+static bool match_file(Regexp* regexp, FILE* file) {
+  char* chunk = malloc(INPUT_CHUNK_SIZE);
+  RegexpStream* stream = create_regexp_stream(regexp);
+  size_t len;
+  while ((len = fread(chunk, 1, INPUT_CHUNK_SIZE, file)) > 0) {
+    feed_regexp_stream(stream, chunk, len);
+  }
+  const bool accepted = finish_regexp_stream(stream);
+  delete_regexp_stream(stream);
+  free(chunk);
+  return accepted;
+}
+
+/// @brief Prints the line, prefixed with the name of its file if data isn't
+/// NULL.
+static bool print_line(const char* line, size_t len, void* data) {
+  if (data) {
+    fprintf(stdout, "%s:", (const char*)data);
+  }
+  fwrite(line, 1, len, stdout);
+  fputc('\n', stdout);
+  return true;
+}
+
+/// @brief Stops at the first line matched.
+static bool stop_at_line(const char* line, size_t len, void* data) {
+  (void)line;
+  (void)len;
+  (void)data;
+  return false;
+}
+
+/// @brief Matches the lines with the threads of the options if there are
+/// many, or else with the regexp itself.
+static size_t grep(Regexp* regexp, const MappedFile* file,
+                   const Options* options, OnLineMatched on_matched,
+                   void* data) {
+  if (options->jobs > 1) {
+    return grep_lines_in_parallel(regexp, file->data, file->size,
+                                  options->jobs, on_matched, data);
+  }
+  return grep_lines(regexp, file->data, file->size, on_matched, data);
+}
+
+/// @brief Matches every line of the files, which are mapped into memory, with
+/// the regexp, and prints the lines matched, their numbers or the names of the
+/// files with any.
+/// @return Whether any line is matched and all the files are mapped.
+static bool grep_files(Regexp* regexp, const Options* options) {
+  bool has_matched = false;
+  bool has_failed = false;
+  // the lines and the numbers are prefixed with the names of their files if
+  // there are many
+  const bool is_prefixed = options->num_of_files > 1;
+  for (int i = 0; i < options->num_of_files; i++) {
+    char* filename = options->files[i];
+    MappedFile file;
+    if (!map_file(filename, &file)) {
+      fprintf(stderr, RED "Can't map file: \"%s\": %s\n" NO_COLOR, filename,
+              errno == ENODEV ? "Not a regular file" : strerror(errno));
+      has_failed = true;
+      continue;
+    }
+    size_t num_of_matched;
+    if (options->files_with_matches) {
+      num_of_matched = grep(regexp, &file, options, stop_at_line, NULL);
+      if (num_of_matched) {
+        fprintf(stdout, "%s\n", filename);
+      }
+    } else if (options->count) {
+      num_of_matched = grep(regexp, &file, options, NULL, NULL);
+      if (is_prefixed) {
+        fprintf(stdout, "%s:", filename);
+      }
+      fprintf(stdout, "%zu\n", num_of_matched);
+    } else {
+      num_of_matched = grep(regexp, &file, options, print_line,
+                            is_prefixed ? filename : NULL);
+    }
+    has_matched |= num_of_matched > 0;
+    unmap_file(&file);
+  }
+  return has_matched && !has_failed;
+}
+
+static void print_stats(const Regexp* regexp) {
+  RegexpStats stats;
+  get_regexp_stats(regexp, &stats);
+  fprintf(stderr, "cached dfa states: %zu\n", stats.num_of_dstates);
+  fprintf(stderr, "cache memory: %zu bytes\n", stats.cache_memory);
+  fprintf(stderr, "flushes: %zu\n", stats.num_of_flushes);
+  fprintf(stderr, "evictions: %zu\n", stats.num_of_evictions);
+  fprintf(stderr, "full dfa states: %zu (%zu before minimization)\n",
+          stats.num_of_dfa_states, stats.num_of_unminimized_dfa_states);
+  size_t literal_len;
+  const char* literal = get_regexp_literal(regexp, &literal_len);
+  fprintf(stderr, "required literal: \"%.*s\"\n", (int)literal_len,
+          literal ? literal : "");
+}
+
 int main(int argc, char* argv[]) {
   /* Read command line options */
   Options options;
   options_parser(argc, argv, &options);
 
 #ifdef DEBUG
-  fprintf(stdout, CYAN "Command line options:\n" NO_COLOR);
-  fprintf(stdout, CYAN "  help: %d\n" NO_COLOR, options.help);
-  fprintf(stdout, CYAN "  version: %d\n" NO_COLOR, options.version);
-  fprintf(stdout, CYAN "  cache: %d\n" NO_COLOR, options.cache);
-  fprintf(stdout, CYAN "  graph: %d\n" NO_COLOR, options.graph);
-  fprintf(stdout, CYAN "  filename: %s\n" NO_COLOR, options.filename);
-  fprintf(stdout, CYAN "  regexp: %s\n" NO_COLOR, options.regexp);
-  fprintf(stdout, CYAN "  string: %s\n" NO_COLOR, options.string);
+  fprintf(stderr, CYAN "Command line options:\n" NO_COLOR);
+  fprintf(stderr, CYAN "  help: %d\n" NO_COLOR, options.help);
+  fprintf(stderr, CYAN "  version: %d\n" NO_COLOR, options.version);
+  fprintf(stderr, CYAN "  cache: %d\n" NO_COLOR, options.cache);
+  fprintf(stderr, CYAN "  max memory: %zu\n" NO_COLOR, options.max_memory);
+  fprintf(stderr, CYAN "  stats: %d\n" NO_COLOR, options.stats);
+  fprintf(stderr, CYAN "  dfa: %d\n" NO_COLOR, options.dfa);
+  fprintf(stderr, CYAN "  glushkov: %d\n" NO_COLOR, options.glushkov);
+  fprintf(stderr, CYAN "  graph: %d\n" NO_COLOR, options.graph);
+  fprintf(stderr, CYAN "  utf8: %d\n" NO_COLOR, options.utf8);
+  fprintf(stderr, CYAN "  search: %d\n" NO_COLOR, options.search);
+  fprintf(stderr, CYAN "  grep: %d\n" NO_COLOR, options.grep);
+  fprintf(stderr, CYAN "  count: %d\n" NO_COLOR, options.count);
+  fprintf(stderr, CYAN "  files with matches: %d\n" NO_COLOR,
+          options.files_with_matches);
+  fprintf(stderr, CYAN "  jobs: %d\n" NO_COLOR, options.jobs);
+  fprintf(stderr, CYAN "  files: %d\n" NO_COLOR, options.num_of_files);
+  for (int i = 0; i < options.num_of_files; i++) {
+    fprintf(stderr, CYAN "    %s\n" NO_COLOR, options.files[i]);
+  }
+  fprintf(stderr, CYAN "  filename: %s\n" NO_COLOR, options.filename);
+  fprintf(stderr, CYAN "  input: %s\n" NO_COLOR,
+          options.input ? options.input : "(none)");
+  fprintf(stderr, CYAN "  regexp: %s\n" NO_COLOR, options.regexp);
+  fprintf(stderr, CYAN "  string: %s\n" NO_COLOR, options.string);
 #endif
 
-  const char* post = re2post(options.regexp);
-  if (!post) {
+  RegexpOptions regexp_options;
+  init_regexp_options(&regexp_options);
+  // the grep mode matches many lines, which the DFA cache pays off for
+  regexp_options.cache = options.cache || (options.grep && !options.dfa);
+  regexp_options.cache_budget = options.max_memory;
+  regexp_options.dfa = options.dfa;
+  regexp_options.glushkov = options.glushkov;
+  regexp_options.utf8 = options.utf8;
+  regexp_options.search = options.search;
+  Regexp* regexp = compile_regexp(options.regexp, &regexp_options);
+  if (!regexp) {
     fprintf(stderr,
-            RED "The regexp \"%s\" is ill-formed or too long.\n" NO_COLOR,
+            RED "The regexp \"%s\" is ill-formed or repeats too much.\n"
+                NO_COLOR,
             options.regexp);
     exit(EXIT_FAILURE);
   }
 
-  Nfa* nfa = post2nfa(post);
   if (options.graph) {
-    char filename[BUF_SIZE + 4];
-    snprintf(filename, BUF_SIZE + 4, "%s.dot", options.filename);
+    const size_t filename_size = strlen(options.filename) + sizeof(".dot");
+    char* filename = malloc(filename_size);
+    snprintf(filename, filename_size, "%s.dot", options.filename);
     FILE* dotfile = fopen(filename, "w");
     if (!dotfile) {
       fprintf(stderr, RED "Can't open file: \"%s\"\n" NO_COLOR, filename);
       exit(EXIT_FAILURE);
     }
-    nfa2dot(nfa, dotfile);
+    nfa2dot(get_regexp_nfa(regexp), dotfile);
+    regexp_options.simplify = false;
+    Regexp* unsimplified = compile_regexp(options.regexp, &regexp_options);
+    fprintf(stderr, "nfa states: %d (%d before simplification)\n",
+            get_regexp_prog(regexp)->num_of_insts,
+            get_regexp_prog(unsimplified)->num_of_insts);
+    delete_regexp(unsimplified);
 #ifdef DEBUG
     fprintf(stdout, YELLOW "Dot file written to \"%s\"\n" NO_COLOR, filename);
 #endif
     fclose(dotfile);
-    delete_nfa(nfa);
+    free(filename);
+    delete_regexp(regexp);
     return EXIT_SUCCESS;
   }
 
-  bool matches_the_string = options.cache
-                                ? is_accepted_with_cache(nfa, options.string)
-                                : is_accepted(nfa, options.string);
+  if (options.grep) {
+    const bool has_matched = grep_files(regexp, &options);
+    if (options.stats) {
+      print_stats(regexp);
+    }
+    delete_regexp(regexp);
+    return has_matched ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  bool matches_the_string;
+  if (options.input) {
+    const bool is_stdin = strcmp(options.input, "-") == 0;
+    FILE* input = is_stdin ? stdin : fopen(options.input, "rb");
+    if (!input) {
+      fprintf(stderr, RED "Can't open file: \"%s\"\n" NO_COLOR, options.input);
+      exit(EXIT_FAILURE);
+    }
+    matches_the_string = match_file(regexp, input);
+    if (ferror(input)) {
+      fprintf(stderr, RED "Can't read file: \"%s\"\n" NO_COLOR, options.input);
+      exit(EXIT_FAILURE);
+    }
+    if (!is_stdin) {
+      fclose(input);
+    }
+  } else {
+    matches_the_string = match_regexp(regexp, options.string);
+  }
+  if (options.stats) {
+    print_stats(regexp);
+  }
 #ifdef DEBUG
   if (matches_the_string) {
     fprintf(stdout, YELLOW "The regexp matches the string.\n" NO_COLOR);
@@ -68,6 +241,6 @@ int main(int argc, char* argv[]) {
     fprintf(stdout, RED "The regexp doesn't match the string.\n" NO_COLOR);
   }
 #endif
-  delete_nfa(nfa);
+  delete_regexp(regexp);
   return matches_the_string ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -3,202 +3,196 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
-#include "prime.h"
-
-typedef struct MapPair {
+/// @brief The state of a slot. A deleted slot is left as a tombstone, which
+/// keeps the probe chains through it unbroken.
+typedef enum SlotState {
+  SLOT_EMPTY = 0,
+  SLOT_USED,
+  SLOT_DELETED,
+} SlotState;
+
+/// @brief The pairs are stored inline in the slots, so probing walks
+/// contiguous memory and no allocation is made per pair.
+typedef struct MapSlot {
   int key;
-  void* val;  // void* is used for generic
-} MapPair;
+  unsigned char state;  // of SlotState, packed into the padding after key
+  void* val;            // void* is used for generic
+} MapSlot;
 
 struct Map {
-  int capacity;
-  int size;
-  MapPair** pairs;
+  /// @brief Always a power of two, so a hash is reduced with a mask.
+  size_t capacity;
+  /// @brief The number of pairs.
+  size_t size;
+  size_t num_of_tombstones;
+  /// @brief log2(capacity), which is how many bits a hash takes.
+  int shift;
+  MapSlot* slots;
 };
 
 size_t get_size(Map* map) {
   return map->size;
 }
 
-/// @note val may or may not be heap-allocated, its ownership isn't taken.
-static MapPair* create_map_pair(int key, void* val) {
-  MapPair* item = malloc(sizeof(MapPair));
-  item->key = key;
-  item->val = val;
-  return item;
+size_t get_memory_usage(Map* map) {
+  return sizeof(Map) + sizeof(MapSlot) * map->capacity;
 }
 
-/// @note The val in the map pair is not freed.
-static void delete_map_pair(MapPair* item) {
-  free(item);
+/// @return Whether size pairs and tombstones keep the load of the capacity
+/// within 70%.
+static bool fits_in(size_t size, size_t capacity) {
+  return size * 10 <= capacity * 7;
 }
 
-static Map* create_map_with_capacity(int capacity) {
-  Map* map = malloc(sizeof(Map));
+/// @return The smallest power of two, not lower than MAP_BASE_CAPACITY, which
+/// holds size pairs.
+static size_t get_capacity_for(size_t size) {
+  size_t capacity = 1;
+  while (capacity < MAP_BASE_CAPACITY || !fits_in(size, capacity)) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+/// @brief Allocates all-empty slots for the capacity, which is a power of two.
+static void init_slots(Map* map, size_t capacity) {
   map->capacity = capacity;
   map->size = 0;
-  // initialize to NULL, which means unused
-  map->pairs = calloc(map->capacity, sizeof(MapPair));
+  map->num_of_tombstones = 0;
+  map->shift = 0;
+  while ((size_t)1 << map->shift < capacity) {
+    map->shift++;
+  }
+  map->slots = calloc(capacity, sizeof(MapSlot));
+}
+
+Map* create_map_with_capacity(size_t capacity) {
+  Map* map = malloc(sizeof(Map));
+  init_slots(map, get_capacity_for(capacity));
   return map;
 }
 
 Map* create_map() {
-  return create_map_with_capacity(next_prime(MAP_BASE_CAPACITY));
+  return create_map_with_capacity(0);
 }
 
 void delete_map(Map* map) {
-  for (int i = 0; i < map->capacity; i++) {
-    if (map->pairs[i]) {
-      delete_map_pair(map->pairs[i]);
-      map->pairs[i] = NULL;
-    }
-  }
-  free(map->pairs);
+  free(map->slots);
   free(map);
 }
 
-/// @return An integer in [0, prime - 1].
-/// @details Division hashing.
-static int hash1(int n, int prime) {
-  return n % prime;
-}
-
-/// @return A integer in [1, prime].
-/// @note Does not yield 0.
-/// @details Division hashing.
-static int hash2(int n, int prime) {
-  return prime - n % prime;
-}
-
-/// @brief A double hashing function that hashes the key into [0, capacity).
-/// @note Hashing is a large topic. This hash function is easy but may not be
-/// good.
-static int get_hashed_key(int key, int capacity, int attempt) {
-  // the capacity we used is already a prime number
-  int prime_1 = capacity;
-  // a smaller prime in comparison with prime_1
-  // and should be relatively prime with the capacity
-  int prime_2 = 7;
-  return (hash1(key, prime_1) + hash2(key, prime_2) * attempt) % capacity;
-}
-
-static MapPair* const PAIR_DELETED_MARKER = NULL;
-
-/// @return Whether the key of the pair is "key".
-/// @note Not null-safe.
-static bool has_key(MapPair* pair, int key) {
-  return pair != PAIR_DELETED_MARKER && pair->key == key;
-}
-
-/// @note An internal-use-only helper that returns the pair for modification.
-/// @return The pointer to the position of the pair with key. If the key does
-/// not exist, returns the position where the key will be if it is inserted.
-static MapPair** search_map_pair(Map* map, int key) {
-  int attempt = 0;
-  int i;
-  do {
-    i = get_hashed_key(key, map->capacity, attempt++);
-  } while (map->pairs[i] && !has_key(map->pairs[i], key));
-  return &map->pairs[i];
+/// @return The first slot to probe for the key.
+/// @details Fibonacci hashing: the key is multiplied by 2^32 divided by the
+/// golden ratio and the top bits are taken, which spreads consecutive keys
+/// across the slots.
+static size_t hash_key(const Map* map, int key) {
+  if (map->shift == 0) {
+    return 0;
+  }
+  return (uint32_t)((uint32_t)key * 2654435769u) >> (32 - map->shift);
 }
 
-/// @return An integer between 0 and 100.
-static int get_load_factor(Map* map) {
-  // avoid floating-point arithmetic
-  return map->size * 100 / map->capacity;
+/// @return The slot of the key; NULL if not exists.
+static MapSlot* find_slot(const Map* map, int key) {
+  const size_t mask = map->capacity - 1;
+  for (size_t i = hash_key(map, key);; i = (i + 1) & mask) {
+    MapSlot* slot = &map->slots[i];
+    if (slot->state == SLOT_EMPTY) {
+      return NULL;
+    }
+    if (slot->state == SLOT_USED && slot->key == key) {
+      return slot;
+    }
+  }
 }
 
-static bool is_high_load(Map* map) {
-  return get_load_factor(map) > 70;
+/// @brief Rehashes the pairs into slots of the capacity, which also drops the
+/// tombstones.
+static void rehash_map(Map* map, size_t capacity) {
+  MapSlot* old_slots = map->slots;
+  const size_t old_capacity = map->capacity;
+  init_slots(map, capacity);
+  const size_t mask = map->capacity - 1;
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old_slots[i].state != SLOT_USED) {
+      continue;
+    }
+    // the keys are distinct, so the first empty slot is where it goes
+    size_t j = hash_key(map, old_slots[i].key);
+    while (map->slots[j].state != SLOT_EMPTY) {
+      j = (j + 1) & mask;
+    }
+    map->slots[j] = old_slots[i];
+    map->size++;
+  }
+  free(old_slots);
 }
 
-static bool is_low_load(Map* map) {
-  return get_load_factor(map) < 10;
+void reserve_map(Map* map, size_t capacity) {
+  const size_t new_capacity = get_capacity_for(capacity);
+  if (new_capacity > map->capacity) {
+    rehash_map(map, new_capacity);
+  }
 }
 
-/// @note If the capacity is lower than MAP_BASE_CAPACITY, MAP_BASE_CAPACITY is
-/// used; if the capacity is not a prime number, the greater closet prime number
-/// is used.
-static void resize_map(Map* old, int capacity);
-
-/// @details Double up the capacity if the map is under high load after the
-/// insertion.
+/// @details The probe reuses the first tombstone it passes if the key doesn't
+/// exist. The map is rehashed before the pairs and the tombstones together
+/// exceed the load, into doubled slots if the pairs alone take more than half
+/// of it, so a map of churning keys is cleaned up instead of growing.
 void insert_pair(Map* map, int key, void* val) {
-  MapPair** pair_p = search_map_pair(map, key);
-  if (*pair_p) {
-    delete_map_pair(*pair_p);
-    map->size--;
+  MapSlot* slot = find_slot(map, key);
+  if (slot) {
+    slot->val = val;
+    return;
   }
-  *pair_p = create_map_pair(key, val);
-  map->size++;
-
-  if (is_high_load(map)) {
-    resize_map(map, map->capacity * 2);
+  if (!fits_in(map->size + map->num_of_tombstones + 1, map->capacity)) {
+    rehash_map(map, fits_in((map->size + 1) * 2, map->capacity)
+                        ? map->capacity
+                        : map->capacity * 2);
+  }
+  const size_t mask = map->capacity - 1;
+  size_t i = hash_key(map, key);
+  while (map->slots[i].state == SLOT_USED) {
+    i = (i + 1) & mask;
+  }
+  slot = &map->slots[i];
+  if (slot->state == SLOT_DELETED) {
+    map->num_of_tombstones--;
   }
+  slot->key = key;
+  slot->state = SLOT_USED;
+  slot->val = val;
+  map->size++;
 }
 
 void* get_value(Map* map, int key) {
-  MapPair** pair_p = search_map_pair(map, key);
-  return *pair_p ? (*pair_p)->val : NULL;
+  const MapSlot* slot = find_slot(map, key);
+  return slot ? slot->val : NULL;
 }
 
-/// @details Half down the capacity if the map is under low load after the
-/// deletion.
+/// @details The slot is left as a tombstone; the map never shrinks.
 void delete_pair(Map* map, int key) {
-  MapPair** pair_p = search_map_pair(map, key);
-  if (*pair_p) {
-    delete_map_pair(*pair_p);
-    *pair_p = PAIR_DELETED_MARKER;
+  MapSlot* slot = find_slot(map, key);
+  if (slot) {
+    slot->state = SLOT_DELETED;
+    slot->val = NULL;
     map->size--;
-
-    if (is_low_load(map)) {
-      resize_map(map, map->capacity / 2);
-    }
+    map->num_of_tombstones++;
   }
 }
 
-static void resize_map(Map* old, int capacity) {
-  if (capacity < MAP_BASE_CAPACITY) {
-    capacity = MAP_BASE_CAPACITY;
-  }
-  if (!is_prime(capacity)) {
-    capacity = next_prime(capacity);
-  }
-
-  // 1. Create a new map with the new capacity
-  Map* new = create_map_with_capacity(capacity);
-
-  // 2. Insert the pairs of the old map into the new map
-  for (int i = 0; i < old->capacity; i++) {
-    MapPair* item = old->pairs[i];
-    if (item && item != PAIR_DELETED_MARKER) {
-      insert_pair(new, item->key, item->val);
-    }
-  }
-
-  // 3. Point to the new map
-  Map map_to_free = *old;
-  *old = *new;
-
-  // 4. Free the old map
-  *new = map_to_free;
-  // free the pairs from old and the map itself from new
-  delete_map(new);
+void init_map_iterator(MapIterator* itr, Map* map) {
+  itr->map = map;
+  itr->pos = -1;  // if init to 0, to_next may skip the first used pair
+  itr->seen_so_far = 0;
 }
 
-struct MapIterator {
-  int pos;
-  unsigned seen_so_far;
-  Map* map;
-};
-
 MapIterator* create_map_iterator(Map* map) {
   MapIterator* itr = malloc(sizeof(MapIterator));
-  itr->map = map;
-  itr->pos = -1;  // if init to 0, to_next may skip the first used pair
-  itr->seen_so_far = 0;
+  init_map_iterator(itr, map);
   return itr;
 }
 
@@ -212,9 +206,8 @@ bool has_next(MapIterator* itr) {
 
 void to_next(MapIterator* itr) {
   assert(has_next(itr));
-  for (itr->pos++; itr->pos < itr->map->capacity; itr->pos++) {
-    if (itr->map->pairs[itr->pos]
-        && itr->map->pairs[itr->pos] != PAIR_DELETED_MARKER) {
+  for (itr->pos++; (size_t)itr->pos < itr->map->capacity; itr->pos++) {
+    if (itr->map->slots[itr->pos].state == SLOT_USED) {
       itr->seen_so_far++;
       return;
     }
@@ -223,10 +216,10 @@ void to_next(MapIterator* itr) {
 
 int get_current_key(MapIterator* itr) {
   assert(itr->pos != -1);
-  return itr->map->pairs[itr->pos]->key;
+  return itr->map->slots[itr->pos].key;
 }
 
 void* get_current_value(MapIterator* itr) {
   assert(itr->pos != -1);
-  return itr->map->pairs[itr->pos]->val;
+  return itr->map->slots[itr->pos].val;
 }
@@ -6,20 +6,31 @@
 
 #ifndef MAP_BASE_CAPACITY
 /// @brief Define before including this file if you want to use another base
-/// capacity. The actual capacity will be the greater closest prime.
-#define MAP_BASE_CAPACITY 53
+/// capacity. The actual capacity will be the greater closest power of two.
+#define MAP_BASE_CAPACITY 64
 #endif
 
 typedef struct Map Map;
 
 size_t get_size(Map*);
 
+/// @return The number of bytes allocated by the map, excluding the vals.
+size_t get_memory_usage(Map*);
+
 /// @note Should be freed after use with delete_map.
 Map* create_map();
 
+/// @return A map which holds capacity pairs without growing.
+/// @note Should be freed after use with delete_map.
+Map* create_map_with_capacity(size_t capacity);
+
 /// @note Frees the map created previously with create_map.
 void delete_map(Map*);
 
+/// @brief Grows the map so that it holds capacity pairs in total without
+/// growing again. Never shrinks the map.
+void reserve_map(Map*, size_t capacity);
+
 /// @brief Inserts the key-val pair into the map. val is updated if key
 /// already exists.
 /// @note The val may or may not be heap-allocated since the map does
@@ -34,10 +45,21 @@ void* get_value(Map*, int key);
 /// @note The val is not freed since its ownership isn't taken.
 void delete_pair(Map*, int key);
 
-typedef struct MapIterator MapIterator;
+/// @brief Iterates over the pairs of a map. It's small enough to live on the
+/// stack, see init_map_iterator.
+typedef struct MapIterator {
+  Map* map;
+  /// @brief The slot of the current pair; -1 before the first call on
+  /// to_next.
+  int pos;
+  size_t seen_so_far;
+} MapIterator;
+
+/// @brief Starts the iterator at the beginning of the map.
+void init_map_iterator(MapIterator*, Map*);
 
 /// @note The iterator becomes invalid once an operation is made during
-/// iteration.
+/// iteration. Should be freed after use with delete_map_iterator.
 MapIterator* create_map_iterator(Map*);
 void delete_map_iterator(MapIterator*);
 
@@ -62,16 +84,17 @@ void to_next(MapIterator*);
 /// statement can use the `continue` and `break` keywords to control the
 /// iteration, and the `return` keyword to exit the function that calls this
 /// macro.
-/// @note This macro creates an iterator object internally and deletes it after
-/// the iteration is complete.
-#define FOR_EACH_ITR(map, itr_name, statement)         \
-  {                                                    \
-    MapIterator*(itr_name) = create_map_iterator(map); \
-    while (has_next(itr_name)) {                       \
-      to_next(itr_name);                               \
-      statement;                                       \
-    }                                                  \
-    delete_map_iterator(itr_name);                     \
+/// @note The iterator is allocated on the stack, so nothing has to be freed
+/// after the iteration.
+#define FOR_EACH_ITR(map, itr_name, statement)    \
+  {                                               \
+    MapIterator itr_name##_storage;               \
+    MapIterator*(itr_name) = &itr_name##_storage; \
+    init_map_iterator(itr_name, map);             \
+    while (has_next(itr_name)) {                  \
+      to_next(itr_name);                          \
+      statement;                                  \
+    }                                             \
   }
 
 #endif /* end of include guard: MAP_H */
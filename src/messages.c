@@ -30,7 +30,10 @@ void help() {
  */
 void usage() {
   fprintf(stdout, YELLOW "Usage: " NO_COLOR);
-  fprintf(stdout, "%s [-h] [-V] {-g regexp [-o FILE] | [-c] regexp string}\n\n",
+  fprintf(stdout,
+          "%s [-h] [-V] [-u] [-s] {-g regexp [-o FILE] |"
+          " [-c | -d] [-m BYTES] [-G] [-S] regexp {string | -f FILE} |"
+          " -p [-C | -l] [-j N] [-d] [-m BYTES] [-G] [-S] regexp FILE...}\n\n",
           PROGRAM_NAME);
 }
 
@@ -41,7 +44,7 @@ void description() {
   fprintf(stdout, YELLOW "Description: " NO_COLOR);
   fprintf(stdout,
           "Regular expression implementation.\n"
-          "Supports . ( ) | * + ?. No escapes.\n"
+          "Supports . ( ) | * + ? {n,m} [ ] [^ ]. No escapes.\n"
           "Compiles to NFA and then simulates NFA using Thompson's algorithm.\n"
           "\n"
           "One can either match a string (default) or graph the regexp.\n"
@@ -68,6 +71,31 @@ void graph_mode() {
       "\n" NO_COLOR);
 }
 
+void grep_mode() {
+  fprintf(stdout, WHITE
+          "Grep mode:\n"
+          "  Matches every line of the files with the regular expression,\n"
+          "  which has to match the whole line, and prints the lines\n"
+          "  matched. Exits with 1 if regexp is ill-formed, no line\n"
+          "  matches or a file can't be mapped\n"
+          "\n"
+          "  -p, --grep            Maps the files into memory and matches\n"
+          "                        their lines with a single DFA cache,\n"
+          "                        or the full DFA with --dfa\n"
+          "  -C, --count           Prints only the number of lines matched\n"
+          "                        of each file\n"
+          "  -l, --files-with-matches\n"
+          "                        Prints only the names of the files with\n"
+          "                        any line matched, stopping at the first\n"
+          "  -j N, --jobs N        Matches the lines of each file with N\n"
+          "                        threads, each with a DFA cache of its own\n"
+          "                        (default: 1)\n"
+          "  regexp                The regular expression to use on matching\n"
+          "  FILE...               The files to be matched, whose names\n"
+          "                        prefix the output if there are many\n"
+          "\n" NO_COLOR);
+}
+
 void match_mode() {
   fprintf(stdout, WHITE
           "Match mode:\n"
@@ -75,6 +103,22 @@ void match_mode() {
           "  exits with 1 if regexp is ill-formed or it does not match\n"
           "\n"
           "  -c, --cache           Caches NFA states to build DFA on the fly\n"
+          "  -d, --dfa             Builds the minimized DFA ahead of time,\n"
+          "                        falls back to caching if it's too large\n"
+          "  -m BYTES, --max-memory BYTES\n"
+          "                        The memory budget of the cache, with an\n"
+          "                        optional K, M or G suffix. The cache is\n"
+          "                        flushed once it's exceeded\n"
+          "                        (default: unlimited)\n"
+          "  -G, --glushkov        Compiles the regexp into a position\n"
+          "                        automaton, which has no epsilon\n"
+          "                        transitions\n"
+          "  -S, --stats           Prints the statistics of the DFAs and\n"
+          "                        the required literal to stderr after\n"
+          "                        matching\n"
+          "  -f FILE, --file FILE  Matches the content of the file instead\n"
+          "                        of a string, which is read in chunks;\n"
+          "                        reads stdin if FILE is -\n"
           "  regexp                The regular expression to use on matching\n"
           "  string                The string to be matched\n"
           "\n" NO_COLOR);
@@ -89,9 +133,16 @@ void options() {
           "Options:\n"
           "  -h, --help            Shows this help message and exit\n"
           "  -V, --version         Shows %s version and exit\n"
+          "  -u, --utf8            Takes the regexp and the string as UTF-8,\n"
+          "                        so . and [ ] match a character rather\n"
+          "                        than a byte\n"
+          "  -s, --search          Finds the regexp anywhere in the string\n"
+          "                        or the line rather than matching the\n"
+          "                        whole of it\n"
           "\n" NO_COLOR,
           PROGRAM_NAME);
   match_mode();
+  grep_mode();
   graph_mode();
 }
 
@@ -3,7 +3,9 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "map.h"
+#include "stack.h"
 #include "state.h"
 
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
@@ -14,34 +16,49 @@ Nfa* create_nfa(State* start, State* accept) {
   Nfa* n = malloc(sizeof(Nfa));
   n->start = start;
   n->accept = accept;
+  n->arena = NULL;
+  n->num_of_ids = 0;
   return n;
 }
 
-/// @brief Collects all of the states reachable from start into the map.
-/// @param states Mapping of states which the states will be inserted into.
-/// @param start The start state which all the states reachable from it will be
-/// collected.
-static void collect_reachable_states(Map* states, State* start) {
-  if (get_value(states, start->id)) {
-    return;
-  }
-  insert_pair(states, start->id, start);
-  if (start->label != ACCEPT) {
-    for (size_t i = 0; i < num_of_outs(start->label); i++) {
-      collect_reachable_states(states, start->outs[i]);
-    }
-  }
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+Nfa* create_arena_nfa(Arena* arena, int num_of_ids, State* start,
+                      State* accept) {
+  Nfa* n = create_nfa(start, accept);
+  n->arena = arena;
+  n->num_of_ids = num_of_ids;
+  return n;
 }
 
-/// @brief Deletes all of the states reachable from s.
-static void delete_reachable_states(State* s) {
+/// @brief Deletes all of the states reachable from start.
+/// @details The states are collected with an explicit stack before any is
+/// deleted, so long chains of states can't overflow the call stack.
+static void delete_reachable_states(State* start) {
   Map* states_to_delete = create_map();
-  collect_reachable_states(states_to_delete, s);
+  Stack* to_visit = create_stack();
+  push_stack(to_visit, start);
+  while (!is_empty_stack(to_visit)) {
+    State* s = pop_stack(to_visit);
+    if (get_value(states_to_delete, s->id)) {
+      continue;
+    }
+    insert_pair(states_to_delete, s->id, s);
+    if (s->label != ACCEPT) {
+      for (size_t i = 0; i < num_of_outs(s->label); i++) {
+        push_stack(to_visit, s->outs[i]);
+      }
+    }
+  }
+  delete_stack(to_visit);
   FOR_EACH_ITR(states_to_delete, itr, delete_state(get_current_value(itr)));
   delete_map(states_to_delete);
 }
 
 void delete_nfa(Nfa* nfa) {
-  delete_reachable_states(nfa->start);
+  if (nfa->arena) {
+    delete_arena(nfa->arena);
+  } else {
+    delete_reachable_states(nfa->start);
+  }
   free(nfa);
 }
@@ -1,18 +1,31 @@
 #ifndef NFA_H
 #define NFA_H
 
+#include "arena.h"
 #include "state.h"
 
 typedef struct Nfa {
   State* start;
   State* accept;
+  /// @brief The arena which the states are allocated from; NULL if they are
+  /// created one by one with create_state.
+  Arena* arena;
+  /// @brief The states of an arena are numbered from 0 to num_of_ids - 1; 0 if
+  /// their ids are not dense.
+  int num_of_ids;
 } Nfa;
 
 /// @note The ownership of all the states connected between start and accept are
 /// taken by the NFA.
 Nfa* create_nfa(State* start, State* accept);
 
+/// @brief Creates the NFA of the states allocated from the arena, whose ids
+/// are below num_of_ids.
+/// @note The ownership of the arena is taken by the NFA.
+Nfa* create_arena_nfa(Arena*, int num_of_ids, State* start, State* accept);
+
 /// @brief Deletes the NFA and all the states it contains.
+/// @note The states of an arena are released at once with the arena.
 void delete_nfa(Nfa*);
 
 #endif /* end of include guard: NFA_H s*/
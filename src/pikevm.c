@@ -0,0 +1,83 @@
+#include "pikevm.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "prog.h"
+#include "scratch.h"
+#include "sparseset.h"
+#include "state.h"
+
+size_t get_pike_vm_size(const Prog* prog) {
+  const int n = prog->num_of_insts;
+  return get_scratch_size(sizeof(PikeVm))
+         + get_scratch_size(get_sparse_set_size(n)) * 2
+         + get_scratch_size(sizeof(int) * n);
+}
+
+PikeVm* init_pike_vm(void* memory, const Prog* prog) {
+  const int n = prog->num_of_insts;
+  Scratch scratch;
+  init_scratch(&scratch, memory);
+  PikeVm* vm = take_scratch(&scratch, sizeof(PikeVm));
+  vm->prog = prog;
+  vm->curr = init_sparse_set(take_scratch(&scratch, get_sparse_set_size(n)), n);
+  vm->next = init_sparse_set(take_scratch(&scratch, get_sparse_set_size(n)), n);
+  vm->to_follow = take_scratch(&scratch, sizeof(int) * n);
+  return vm;
+}
+
+/// @details The VM and its lists take a single allocation.
+PikeVm* create_pike_vm(const Prog* prog) {
+  return init_pike_vm(malloc(get_pike_vm_size(prog)), prog);
+}
+
+void delete_pike_vm(PikeVm* vm) {
+  free(vm);
+}
+
+bool run_pike_vm(PikeVm* vm, const char* s, size_t len) {
+  start_pike_vm(vm);
+  feed_pike_vm(vm, s, len);
+  return is_pike_vm_accepting(vm);
+}
+
+void start_pike_vm(PikeVm* vm) {
+  clear_sparse_set(vm->curr);
+  add_initial(vm->prog, vm->curr, vm->to_follow);
+}
+
+/// @details A search stops as soon as the accepting instruction is in the
+/// list, so the rest of the string is never looked at.
+bool feed_pike_vm(PikeVm* vm, const char* s, size_t len) {
+  const Inst* insts = vm->prog->insts;
+  const bool unanchored = vm->prog->unanchored;
+  for (const char* end = s + len; s != end && vm->curr->size; s++) {
+    if (unanchored && contains_sparse_set(vm->curr, vm->prog->accept)) {
+      break;
+    }
+    clear_sparse_set(vm->next);
+    for (int i = 0; i < vm->curr->size; i++) {
+      const int id = vm->curr->dense[i];
+      const Inst* inst = &insts[id];
+      if (inst_takes(vm->prog, inst, *s)) {
+        add_follow(vm->prog, id, vm->next, vm->to_follow);
+      }
+    }
+    if (unanchored) {
+      add_initial(vm->prog, vm->next, vm->to_follow);
+    }
+    SparseSet* tmp = vm->curr;
+    vm->curr = vm->next;
+    vm->next = tmp;
+  }
+  return vm->curr->size;
+}
+
+bool is_pike_vm_accepting(const PikeVm* vm) {
+  // Thompson's construction has exactly one accepting state, so the string is
+  // accepted if it's in the list. The list is empty if the simulation runs out
+  // of states before the end of the string.
+  return contains_sparse_set(vm->curr, vm->prog->accept);
+}
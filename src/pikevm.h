@@ -0,0 +1,55 @@
+#ifndef PIKEVM_H
+#define PIKEVM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "prog.h"
+#include "sparseset.h"
+
+/// @brief Simulates a program with two lists of the current and the next
+/// instructions, which are allocated once and swapped between steps, so no
+/// allocation is made per character. A step takes the union of the
+/// precomputed follows of the instructions moved from.
+typedef struct PikeVm {
+  const Prog* prog;
+  SparseSet* curr;
+  SparseSet* next;
+  /// @brief The instructions whose epsilon outs are yet to be followed, if the
+  /// follows are not precomputed.
+  int* to_follow;
+} PikeVm;
+
+/// @note The program is not owned by the VM and has to outlive it. Should be
+/// freed after use with delete_pike_vm.
+PikeVm* create_pike_vm(const Prog*);
+
+/// @return The number of bytes the VM of the program takes, lists included.
+size_t get_pike_vm_size(const Prog*);
+
+/// @brief Lays out the VM in the memory, which has room for
+/// get_pike_vm_size(prog) bytes and is aligned as malloc'd memory is, so the
+/// program is simulated in memory of the caller.
+/// @note The memory is owned by the caller, so the VM is never deleted.
+PikeVm* init_pike_vm(void* memory, const Prog*);
+
+void delete_pike_vm(PikeVm*);
+
+/// @return Whether the len bytes of s, which may have any value, null bytes
+/// included, are accepted by the program.
+bool run_pike_vm(PikeVm*, const char* s, size_t len);
+
+/// @brief Starts the VM over at the initial instructions, so a string can be
+/// fed to it in chunks with feed_pike_vm.
+void start_pike_vm(PikeVm*);
+
+/// @brief Steps the VM on the len bytes of s, which follow the bytes fed since
+/// the start.
+/// @return Whether any instruction is left; once none is, no string that
+/// starts with the bytes fed is accepted.
+bool feed_pike_vm(PikeVm*, const char* s, size_t len);
+
+/// @return Whether the bytes fed since the start are accepted.
+bool is_pike_vm_accepting(const PikeVm*);
+
+#endif /* end of include guard: PIKEVM_H */
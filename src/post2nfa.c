@@ -1,33 +1,50 @@
 #include "post2nfa.h"
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "arena.h"
+#include "byteset.h"
 #include "nfa.h"
 #include "state.h"
 
 /// @brief Merges b into a, which connects the outs of b to a.
 /// @param a The state to be replace. It's contents will be lost.
 /// @param b The state to replace with.
-/// @note State b is deleted after the merge.
-static void merge_state(State* a, State* b) {
-  free(a->outs);
+/// @note State b is unreachable after the merge, and is released along with
+/// the arena.
+static void merge_state(State* a, const State* b) {
   a->label = b->label;
-  a->outs = b->outs;
-  free(b);
+  a->set = b->set;
+  a->outs[0] = b->outs[0];
+  a->outs[1] = b->outs[1];
 }
 
 /*
  * Implements the McNaughton-Yamada-Thompson algorithm with extra supports on +
  * (one or more) and ? (zero or one) operators.
+ *
+ * All states are allocated from an arena, which is owned by the resulting NFA,
+ * and the sub-NFAs are kept by value on the stack, so the construction makes
+ * no allocation per state and an ill-formed regexp is cleaned up at once. Each
+ * symbol pushes at most one sub-NFA, so the stack is sized by the length of
+ * post. A bracket expression becomes a single state labeled by its byte set,
+ * which is allocated from the arena as well. The states are numbered from 0 in
+ * the order of creation, which keeps the ids dense and the construction free of
+ * any shared counter.
  */
 
 Nfa* post2nfa(const char* post) {
-  Nfa* stack[1000];
-  Nfa** top = stack;
+  Nfa* stack = malloc(sizeof(Nfa) * (strlen(post) + 1));
+  Nfa* top = stack;
+  Arena* arena = create_arena();
+  int num_of_states = 0;
 
 #define IS_EMPTY() (top == stack)
-#define PUSH(s) (*top++ = (s))
-#define POP() IS_EMPTY() ? NULL : (*--top)
+#define PUSH(s, a) (*top++ = (Nfa){.start = (s), .accept = (a), .arena = NULL})
+#define POP() (IS_EMPTY() ? NULL : --top)
+#define CREATE_STATE(label, outs) \
+  create_arena_state(arena, num_of_states++, (label), (outs))
 
   for (; *post; post++) {
     switch (*post) {
@@ -35,108 +52,125 @@ Nfa* post2nfa(const char* post) {
         Nfa* n2 = POP();
         Nfa* n1 = POP();
         if (!n1 || !n2) {
-          if (n1) {
-            delete_nfa(n1);
-          }
-          if (n2) {
-            delete_nfa(n2);
-          }
+          delete_arena(arena);
+          free(stack);
           return NULL;
         }
         merge_state(n1->accept, n2->start);
-        PUSH(create_nfa(n1->start, n2->accept));
-        free(n1);
-        free(n2);
+        PUSH(n1->start, n2->accept);
       } break;
       case '|': {
         Nfa* n2 = POP();
         Nfa* n1 = POP();
         if (!n1 || !n2) {
-          if (n1) {
-            delete_nfa(n1);
-          }
-          if (n2) {
-            delete_nfa(n2);
-          }
+          delete_arena(arena);
+          free(stack);
           return NULL;
         }
         State* outs[2] = {n1->start, n2->start};
-        State* start = create_state(SPLIT, outs);
-        State* accept = create_state(ACCEPT, NULL);
+        State* start = CREATE_STATE(SPLIT, outs);
+        State* accept = CREATE_STATE(ACCEPT, NULL);
         n1->accept->label = EPSILON;
         n1->accept->outs[0] = accept;
         n2->accept->label = EPSILON;
         n2->accept->outs[0] = accept;
-        PUSH(create_nfa(start, accept));
-        free(n1);
-        free(n2);
+        PUSH(start, accept);
       } break;
       case '*': {
         Nfa* n = POP();
         if (!n) {
+          delete_arena(arena);
+          free(stack);
           return NULL;
         }
-        State* accept = create_state(ACCEPT, NULL);
+        State* accept = CREATE_STATE(ACCEPT, NULL);
         State* outs[2] = {n->start, accept};
-        State* start = create_state(SPLIT, outs);
-        State* come_back = create_state(SPLIT, start->outs);
-        merge_state(n->accept, come_back);
-        PUSH(create_nfa(start, accept));
-        free(n);
+        State* start = CREATE_STATE(SPLIT, outs);
+        // the accepting state comes back as a split of the same outs
+        n->accept->label = SPLIT;
+        n->accept->outs[0] = n->start;
+        n->accept->outs[1] = accept;
+        PUSH(start, accept);
       } break;
       case '?': {
         Nfa* n = POP();
         if (!n) {
+          delete_arena(arena);
+          free(stack);
           return NULL;
         }
-        State* accept = create_state(ACCEPT, NULL);
+        State* accept = CREATE_STATE(ACCEPT, NULL);
         State* outs[2] = {n->start, accept};
-        State* start = create_state(SPLIT, outs);
+        State* start = CREATE_STATE(SPLIT, outs);
         n->accept->label = EPSILON;
         n->accept->outs[0] = accept;
-        PUSH(create_nfa(start, accept));
-        free(n);
+        PUSH(start, accept);
       } break;
       case '+': {
         Nfa* n = POP();
         if (!n) {
+          delete_arena(arena);
+          free(stack);
           return NULL;
         }
-        State* accept = create_state(ACCEPT, NULL);
-        State* outs[2] = {n->start, accept};
-        State* come_back = create_state(SPLIT, outs);
-        merge_state(n->accept, come_back);
+        State* accept = CREATE_STATE(ACCEPT, NULL);
+        n->accept->label = SPLIT;
+        n->accept->outs[0] = n->start;
+        n->accept->outs[1] = accept;
         // this extra epsilon transition is necessary so that the link doesn't
         // break when merging the start state in concatenation
-        State* start = create_state(EPSILON, &n->start);
-        PUSH(create_nfa(start, accept));
-        free(n);
+        State* start = CREATE_STATE(EPSILON, &n->start);
+        PUSH(start, accept);
       } break;
       case '.': {
-        State* accept = create_state(ACCEPT, NULL);
-        State* start = create_state(ANY, &accept);
-        PUSH(create_nfa(start, accept));
+        State* accept = CREATE_STATE(ACCEPT, NULL);
+        State* start = CREATE_STATE(ANY, &accept);
+        PUSH(start, accept);
+      } break;
+      case '[': {
+        ByteSet* set = alloc_arena(arena, sizeof(ByteSet));
+        const char* end = parse_byte_set(post, set);
+        if (!end) {
+          delete_arena(arena);
+          free(stack);
+          return NULL;
+        }
+        post = end - 1;
+        State* accept = CREATE_STATE(ACCEPT, NULL);
+        State* start = CREATE_STATE(CLASS, &accept);
+        start->set = set;
+        PUSH(start, accept);
       } break;
       default: {
-        State* accept = create_state(ACCEPT, NULL);
-        State* start = create_state(*post, &accept);
-        PUSH(create_nfa(start, accept));
+        State* accept = CREATE_STATE(ACCEPT, NULL);
+        State* start = CREATE_STATE((unsigned char)*post, &accept);
+        PUSH(start, accept);
       } break;
     }
   }
 
-  Nfa* nfa = POP();
-  if (!IS_EMPTY()) {
-    delete_nfa(nfa);
-    while (!IS_EMPTY()) {
-      Nfa* n = POP();
-      delete_nfa(n);
-    }
+  Nfa* n = POP();
+  if (!n || !IS_EMPTY()) {
+    delete_arena(arena);
+    free(stack);
     return NULL;
   }
+  Nfa* nfa = create_arena_nfa(arena, num_of_states, n->start, n->accept);
+  free(stack);
   return nfa;
 
+#undef CREATE_STATE
 #undef POP
 #undef PUSH
 #undef IS_EMPTY
 }
+
+Nfa* re2nfa(const char* re) {
+  char* post = re2post(re);
+  if (!post) {
+    return NULL;
+  }
+  Nfa* nfa = post2nfa(post);
+  free(post);
+  return nfa;
+}
@@ -4,6 +4,16 @@
 #include "nfa.h"
 #include "re2post.h"
 
+/// @brief Builds the NFA of the postfix regexp with Thompson's construction.
+/// @return The NFA; NULL if post is ill-formed.
+/// @note Takes time and memory linear in the length of post. Should be freed
+/// after use with delete_nfa.
 Nfa* post2nfa(const char* post);
 
+/// @brief Converts the infix regexp to postfix with re2post and then builds
+/// its NFA with post2nfa.
+/// @return The NFA; NULL if re is ill-formed.
+/// @note Should be freed after use with delete_nfa.
+Nfa* re2nfa(const char* re);
+
 #endif /* end of include guard: POST2NFA_H */
@@ -1,11 +0,0 @@
-#ifndef PRIME_H
-#define PRIME_H
-
-#include <stdbool.h>
-
-bool is_prime(int n);
-
-/// @return The first prime equal or larger than n.
-int next_prime(int n);
-
-#endif /* end of include guard: PRIME_H */
@@ -0,0 +1,329 @@
+#include "prog.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "byteset.h"
+#include "map.h"
+#include "nfa.h"
+#include "sparseset.h"
+#include "stack.h"
+#include "state.h"
+
+/// @brief Collects the states reachable from start in depth-first order, so
+/// the start state is the first.
+/// @param num_of_ids The number of ids if they are dense, which are then
+/// marked in a table; 0 to look them up in a map instead.
+/// @param num_of_states Set to the number of states collected.
+/// @return The collected states.
+static State** collect_states(State* start, int num_of_ids,
+                              int* num_of_states) {
+  int capacity = 16;
+  State** states = malloc(sizeof(State*) * capacity);
+  *num_of_states = 0;
+  bool* is_visited = num_of_ids ? calloc(num_of_ids, sizeof(bool)) : NULL;
+  Map* visited = num_of_ids ? NULL : create_map();
+  Stack* to_visit = create_stack();
+  push_stack(to_visit, start);
+  while (!is_empty_stack(to_visit)) {
+    State* s = pop_stack(to_visit);
+    if (is_visited ? is_visited[s->id] : get_value(visited, s->id) != NULL) {
+      continue;
+    }
+    if (is_visited) {
+      is_visited[s->id] = true;
+    } else {
+      insert_pair(visited, s->id, s);
+    }
+    if (*num_of_states == capacity) {
+      capacity *= 2;
+      states = realloc(states, sizeof(State*) * capacity);
+    }
+    states[(*num_of_states)++] = s;
+    if (s->label != ACCEPT) {
+      // pushed in reverse so that the first out is visited first
+      for (size_t i = num_of_outs(s->label); i > 0; i--) {
+        push_stack(to_visit, s->outs[i - 1]);
+      }
+    }
+  }
+  delete_stack(to_visit);
+  if (visited) {
+    delete_map(visited);
+  }
+  free(is_visited);
+  return states;
+}
+
+bool is_important_inst(const Inst* inst) {
+  return inst->label != EPSILON && inst->label != SPLIT;
+}
+
+/// @brief Follows the epsilon transitions from the instruction and adds all
+/// the instructions reached into the set.
+static void follow_epsilons(const Inst* insts, int id, SparseSet* set,
+                            int* stack) {
+  if (contains_sparse_set(set, id)) {
+    return;
+  }
+  insert_sparse_set(set, id);
+  int top = 0;
+  stack[top++] = id;
+  while (top) {
+    const Inst* inst = &insts[stack[--top]];
+    for (size_t i = 0; i < num_of_epsilon_outs(inst->label); i++) {
+      const int out = inst->outs[i];
+      if (!contains_sparse_set(set, out)) {
+        insert_sparse_set(set, out);
+        stack[top++] = out;
+      }
+    }
+  }
+}
+
+/// @brief The follows collected before being copied into the program.
+typedef struct FollowIds {
+  int* ids;
+  int size;
+  int capacity;
+} FollowIds;
+
+static void push_follow_id(FollowIds* follow_ids, int id) {
+  if (follow_ids->size == follow_ids->capacity) {
+    follow_ids->capacity *= 2;
+    follow_ids->ids
+        = realloc(follow_ids->ids, sizeof(int) * follow_ids->capacity);
+  }
+  follow_ids->ids[follow_ids->size++] = id;
+}
+
+/// @brief The state shared by the computations of the closures.
+typedef struct ClosureContext {
+  const Inst* insts;
+  SparseSet* reached;
+  int* stack;
+  FollowIds ids;
+  /// @brief The range of the closure of each instruction in the ids; -1 if
+  /// not yet computed. The labeled instructions transiting to the same one
+  /// share its closure.
+  int* closure_begin;
+  int* closure_end;
+  /// @brief The instructions visited count towards the cap even if they are
+  /// not important, so long epsilon chains can't make it quadratic either.
+  long num_of_visited;
+} ClosureContext;
+
+/// @return Whether the closure is computed within the cap.
+static bool precompute_closure(ClosureContext* ctx, int root) {
+  if (ctx->closure_begin[root] != -1) {
+    return true;  // shared by another instruction
+  }
+  clear_sparse_set(ctx->reached);
+  follow_epsilons(ctx->insts, root, ctx->reached, ctx->stack);
+  ctx->num_of_visited += ctx->reached->size;
+  if (ctx->num_of_visited > PROG_MAX_FOLLOW_IDS) {
+    return false;
+  }
+  ctx->closure_begin[root] = ctx->ids.size;
+  for (int i = 0; i < ctx->reached->size; i++) {
+    const int id = ctx->reached->dense[i];
+    if (is_important_inst(&ctx->insts[id])) {
+      push_follow_id(&ctx->ids, id);
+    }
+  }
+  ctx->closure_end[root] = ctx->ids.size;
+  return true;
+}
+
+static void reset_follows(Prog* prog) {
+  prog->initial_begin = prog->initial_end = -1;
+  for (int i = 0; i < prog->num_of_insts; i++) {
+    prog->insts[i].follow_begin = prog->insts[i].follow_end = -1;
+  }
+}
+
+/// @brief Computes the initial instructions, which are the closure of the
+/// start instruction, and the follow of each labeled instruction, which is the
+/// closure of the instruction it transits to.
+/// @note None of the follows is kept if they take more than
+/// PROG_MAX_FOLLOW_IDS steps to compute.
+static void compute_follows(Prog* prog, FollowIds* ids) {
+  const int n = prog->num_of_insts;
+  reset_follows(prog);
+  ClosureContext ctx = {.insts = prog->insts,
+                        .reached = create_sparse_set(n),
+                        .stack = malloc(sizeof(int) * n),
+                        .ids = *ids,
+                        .closure_begin = malloc(sizeof(int) * n),
+                        .closure_end = malloc(sizeof(int) * n),
+                        .num_of_visited = 0};
+  for (int i = 0; i < n; i++) {
+    ctx.closure_begin[i] = ctx.closure_end[i] = -1;
+  }
+  bool is_within_cap = precompute_closure(&ctx, prog->start);
+  for (int i = 0; i < n && is_within_cap; i++) {
+    const Inst* inst = &prog->insts[i];
+    if (is_important_inst(inst) && inst->label != ACCEPT) {
+      is_within_cap = precompute_closure(&ctx, inst->outs[0]);
+    }
+  }
+  if (is_within_cap) {
+    prog->initial_begin = ctx.closure_begin[prog->start];
+    prog->initial_end = ctx.closure_end[prog->start];
+    for (int i = 0; i < n; i++) {
+      Inst* inst = &prog->insts[i];
+      if (is_important_inst(inst) && inst->label != ACCEPT) {
+        inst->follow_begin = ctx.closure_begin[inst->outs[0]];
+        inst->follow_end = ctx.closure_end[inst->outs[0]];
+      }
+    }
+  } else {
+    ctx.ids.size = 0;
+  }
+  free(ctx.closure_begin);
+  free(ctx.closure_end);
+  free(ctx.stack);
+  delete_sparse_set(ctx.reached);
+  *ids = ctx.ids;
+}
+
+/// @return The offset of the byte sets from the program, which is padded for
+/// the alignment of their words.
+static size_t get_byte_sets_offset(int num_of_insts) {
+  const size_t offset = sizeof(Prog) + sizeof(Inst) * num_of_insts;
+  const size_t alignment = __alignof__(ByteSet);
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+static size_t get_prog_size(int num_of_insts, int num_of_sets,
+                            int num_of_follow_ids) {
+  return get_byte_sets_offset(num_of_insts) + sizeof(ByteSet) * num_of_sets
+         + sizeof(int) * num_of_follow_ids;
+}
+
+Prog* allocate_prog(int num_of_insts, int num_of_sets, int num_of_follow_ids) {
+  Prog* prog = malloc(
+      get_prog_size(num_of_insts, num_of_sets, num_of_follow_ids));
+  prog->num_of_insts = num_of_insts;
+  prog->unanchored = false;
+  prog->num_of_sets = num_of_sets;
+  prog->num_of_follow_ids = num_of_follow_ids;
+  return prog;
+}
+
+/// @details The states of an NFA have unique but not necessarily dense ids,
+/// which are renumbered by the order of collection through a table indexed by
+/// the ids offset by the smallest one.
+Prog* create_prog(const Nfa* nfa) {
+  int num_of_states = 0;
+  State** states = collect_states(nfa->start, nfa->num_of_ids, &num_of_states);
+  int min_id = states[0]->id;
+  int max_id = states[0]->id;
+  for (int i = 1; i < num_of_states; i++) {
+    if (states[i]->id < min_id) {
+      min_id = states[i]->id;
+    }
+    if (states[i]->id > max_id) {
+      max_id = states[i]->id;
+    }
+  }
+  int* index_of = calloc(max_id - min_id + 1, sizeof(int));
+  for (int i = 0; i < num_of_states; i++) {
+    index_of[states[i]->id - min_id] = i;
+  }
+
+  // the instructions are lowered in place, and moved to their final
+  // allocation once the size of the follows is known
+  Prog* lowered = allocate_prog(num_of_states, 0, 0);
+  lowered->start = 0;
+  lowered->accept = index_of[nfa->accept->id - min_id];
+  int num_of_sets = 0;
+  for (int i = 0; i < num_of_states; i++) {
+    const State* s = states[i];
+    Inst* inst = &lowered->insts[i];
+    inst->label = s->label;
+    inst->set = s->label == CLASS ? num_of_sets++ : -1;
+    inst->outs[0] = inst->outs[1] = -1;
+    if (s->label != ACCEPT) {
+      for (size_t j = 0; j < num_of_outs(s->label); j++) {
+        inst->outs[j] = index_of[s->outs[j]->id - min_id];
+      }
+    }
+  }
+  FollowIds follow_ids
+      = {.ids = malloc(sizeof(int) * 16), .size = 0, .capacity = 16};
+  compute_follows(lowered, &follow_ids);
+
+  Prog* prog = allocate_prog(num_of_states, num_of_sets, follow_ids.size);
+  memcpy(prog, lowered, get_prog_size(num_of_states, 0, 0));
+  prog->num_of_sets = num_of_sets;
+  prog->num_of_follow_ids = follow_ids.size;
+  ByteSet* sets = (ByteSet*)get_byte_sets(prog);
+  for (int i = 0; i < num_of_states; i++) {
+    if (states[i]->label == CLASS) {
+      sets[prog->insts[i].set] = *states[i]->set;
+    }
+  }
+  memcpy((int*)get_follow_ids(prog), follow_ids.ids,
+         sizeof(int) * follow_ids.size);
+  free(follow_ids.ids);
+  delete_prog(lowered);
+  free(index_of);
+  free(states);
+  return prog;
+}
+
+Prog* copy_prog(const Prog* prog) {
+  const size_t size = get_prog_size(prog->num_of_insts, prog->num_of_sets,
+                                    prog->num_of_follow_ids);
+  Prog* copy = malloc(size);
+  memcpy(copy, prog, size);
+  return copy;
+}
+
+void delete_prog(Prog* prog) {
+  free(prog);
+}
+
+bool inst_takes(const Prog* prog, const Inst* inst, char c) {
+  if (inst->label == CLASS) {
+    return contains_byte_set(&get_byte_sets(prog)[inst->set], c);
+  }
+  return inst->label == (unsigned char)c || inst->label == ANY;
+}
+
+const ByteSet* get_byte_sets(const Prog* prog) {
+  return (const ByteSet*)((const char*)prog
+                          + get_byte_sets_offset(prog->num_of_insts));
+}
+
+const int* get_follow_ids(const Prog* prog) {
+  return (const int*)(get_byte_sets(prog) + prog->num_of_sets);
+}
+
+/// @brief Adds the precomputed ids from begin to end - 1 into the set.
+static void add_follow_ids(const Prog* prog, int begin, int end,
+                           SparseSet* set) {
+  const int* follow_ids = get_follow_ids(prog);
+  for (int i = begin; i < end; i++) {
+    insert_sparse_set(set, follow_ids[i]);
+  }
+}
+
+void add_initial(const Prog* prog, SparseSet* set, int* stack) {
+  if (prog->initial_begin == -1) {
+    follow_epsilons(prog->insts, prog->start, set, stack);
+    return;
+  }
+  add_follow_ids(prog, prog->initial_begin, prog->initial_end, set);
+}
+
+void add_follow(const Prog* prog, int id, SparseSet* set, int* stack) {
+  const Inst* inst = &prog->insts[id];
+  if (inst->follow_begin == -1) {
+    follow_epsilons(prog->insts, inst->outs[0], set, stack);
+    return;
+  }
+  add_follow_ids(prog, inst->follow_begin, inst->follow_end, set);
+}
@@ -0,0 +1,110 @@
+#ifndef PROG_H
+#define PROG_H
+
+#include <stdbool.h>
+
+#include "byteset.h"
+#include "nfa.h"
+#include "sparseset.h"
+
+#ifndef PROG_MAX_FOLLOW_IDS
+/// @brief Define before including this file if you want to use another cap on
+/// the total size of the precomputed follows of a program.
+#define PROG_MAX_FOLLOW_IDS (1 << 20)
+#endif
+
+/// @brief A state of the NFA lowered into an instruction of a program.
+typedef struct Inst {
+  /// @brief The label of the state.
+  int label;
+  /// @brief The index of the bytes of a CLASS instruction in
+  /// get_byte_sets(prog); -1 for the others.
+  int set;
+  /// @brief The indices of the instructions transited to, of which there are
+  /// num_of_outs(label); -1 if unused, so the accepting instruction has none.
+  /// @note Unused by the programs without epsilon instructions, whose follows
+  /// are all precomputed.
+  int outs[2];
+  /// @brief The important instructions reached once the labeled instruction
+  /// takes a byte are get_follow_ids(prog)[follow_begin] to
+  /// [follow_end - 1]; both -1 if not precomputed or not labeled.
+  int follow_begin;
+  int follow_end;
+} Inst;
+
+/// @brief The NFA lowered into a contiguous array of instructions, whose ids
+/// are their indices, which are dense from 0 to num_of_insts - 1. The ids can
+/// thus index arrays and bitsets of the states.
+/// @details The byte sets of the CLASS instructions are stored right after the
+/// instructions, followed by the follows, in the same allocation.
+typedef struct Prog {
+  int num_of_insts;
+  /// @brief The id of the instruction of the start state, which is 0 for the
+  /// lowered NFA; -1 if the program has none, whose initial instructions are
+  /// then precomputed.
+  int start;
+  /// @brief The id of the instruction of the accepting state.
+  int accept;
+  /// @brief Whether the program searches for a match anywhere in a string
+  /// rather than matching the whole of it. The initial instructions are then
+  /// added back at every step, so a match may start at any byte, and the
+  /// simulation stops once the accepting instruction is reached, so it may end
+  /// at any byte too.
+  bool unanchored;
+  /// @brief The important instructions the simulation starts with are
+  /// get_follow_ids(prog)[initial_begin] to [initial_end - 1]; both -1 if not
+  /// precomputed.
+  int initial_begin;
+  int initial_end;
+  int num_of_sets;
+  /// @brief The total size of the precomputed follows.
+  int num_of_follow_ids;
+  Inst insts[];
+} Prog;
+
+/// @brief Lowers the states reachable from the start state of the NFA into a
+/// program.
+/// @details The initial instructions and the follows of the labeled ones are
+/// precomputed by following the epsilon transitions, unless they would take
+/// more than PROG_MAX_FOLLOW_IDS ids in total.
+/// @note The NFA is not modified. Should be freed after use with delete_prog.
+Prog* create_prog(const Nfa*);
+
+/// @return A program with room for the instructions, the byte sets and the
+/// follow ids, which are left for the caller to fill in.
+/// @note Should be freed after use with delete_prog.
+Prog* allocate_prog(int num_of_insts, int num_of_sets, int num_of_follow_ids);
+
+/// @return A copy of the program, which takes a single allocation.
+/// @note Should be freed after use with delete_prog.
+Prog* copy_prog(const Prog*);
+
+void delete_prog(Prog*);
+
+/// @return Whether the instruction takes a byte or accepts, which are those
+/// that matter after the epsilon transitions are followed.
+bool is_important_inst(const Inst*);
+
+/// @return Whether the instruction takes the byte, which none but the labeled
+/// ones do.
+bool inst_takes(const Prog*, const Inst*, char c);
+
+/// @return The array which the sets of the CLASS instructions index into.
+const ByteSet* get_byte_sets(const Prog*);
+
+/// @return The array which the follows of the instructions index into.
+const int* get_follow_ids(const Prog*);
+
+/// @brief Adds the important instructions the simulation starts with into the
+/// set. The precomputed ones are used if any; otherwise the epsilon
+/// transitions are followed from the start instruction, which also adds the
+/// epsilon instructions.
+/// @param stack Room for num_of_insts ids.
+void add_initial(const Prog*, SparseSet* set, int* stack);
+
+/// @brief Adds the important instructions reached once the labeled instruction
+/// takes a byte into the set, in the same way as add_initial does.
+/// @param stack Room for num_of_insts ids.
+void add_follow(const Prog*, int id, SparseSet* set, int* stack);
+
+#endif /* end of include guard: PROG_H */
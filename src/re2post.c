@@ -13,9 +13,8 @@ https://opensource.org/license/mit/.
 #include <stdlib.h>
 #include <string.h>
 
-#include "stack.h"
-
-#define BUF_SIZE 8000
+#include "byteset.h"
+#include "utf8.h"
 
 /// @brief operators eat up symbols immediately, while the two binary operators,
 /// . and |, don't. Since the union operator is explicitly notated in the
@@ -23,17 +22,34 @@ https://opensource.org/license/mit/.
 typedef struct {
   int num_of_union;
   int num_of_unit;
+  /// @brief The offsets in the result the parenthesized unit and the last unit
+  /// in it start at. The last unit is the operand of a counted repetition.
+  size_t begin;
+  size_t last_unit_begin;
+  /// @brief Whether the last unit is dropped by a repetition of at most 0
+  /// times, which leaves the empty string that any repetition keeps as is.
+  bool is_last_unit_dropped;
 } Unit;
 
-/// @brief whether the buffer may overflow after adding explicit concatenation
-/// symbols.
-static bool buf_may_overflow(const char* re);
+/// @brief The bounds of a counted repetition.
+typedef struct {
+  int min;
+  /// @brief -1 if unbounded.
+  int max;
+} Bounds;
 
 static bool has_unit_to_operate(Unit unit);
 static bool has_units_to_concat(Unit unit);
 static bool has_units_to_union(Unit unit);
 
-static void init_unit(Unit* unit);
+static void init_unit(Unit* unit, size_t begin);
+
+/// @brief Appends the operand, which is a new unit, to the result.
+/// @param unit records the units.
+/// @param result_begin the start of the result, which the unit is offset from.
+/// @param result appends the operand to.
+static void append_operand(Unit* unit, const char* operand, size_t len,
+                           const char* result_begin, char** result);
 
 /// @brief Tries to append a explicit concatenation operator to the result.
 /// @param unit records the number of concatenations awaiting.
@@ -50,33 +66,91 @@ static void try_append_concat(Unit* unit, char** result);
 /// @param result appends the operator to.
 static void try_append_unions(Unit* unit, char** result);
 
+/// @brief Parses the bounds of the counted repetition which s starts with,
+/// which is one of {n}, {n,} and {n,m}.
+/// @return The end of the bounds, which is right after the closing }; NULL if s
+/// doesn't start with bounds.
+static const char* parse_bounds(const char* s, Bounds* bounds);
+
+/// @return Whether the bounds are within RE2POST_MAX_REPEAT and in order.
+static bool are_valid_bounds(Bounds bounds);
+
+/// @brief Writes the repetition of the operand at the end of the result in
+/// place of the operand.
+/// @param operand The copy of the operand.
+/// @param result appends the repetition to, which is where the operand starts.
+static void write_repetition(const char* operand, size_t operand_len,
+                             Bounds bounds, char** result);
+
+/// @return The length of the repetition write_repetition writes.
+static size_t get_repetition_len(size_t operand_len, Bounds bounds);
+
+/// @brief Converts re in the way re2post does, or re2post_utf8 does if
+/// is_utf8.
+static char* convert(const char* re, bool is_utf8);
+
+/// @brief Appends the operand, which is written out rather than copied from
+/// re, like append_operand, growing the result by its length first.
+/// @param capacity The capacity of the result, which is updated.
+/// @return The result, which may be moved on growing.
+static char* append_written_operand(Unit* unit, const char* operand,
+                                    char* result, char** result_tail,
+                                    size_t* capacity);
+
+char* re2post(const char* re) {
+  return convert(re, false);
+}
+
+char* re2post_utf8(const char* re) {
+  return convert(re, true);
+}
+
+bool is_operator_byte(unsigned char byte) {
+  return byte == '\0' || byte == EXPLICIT_CONCAT || byte == '|' || byte == '*'
+         || byte == '+' || byte == '?' || byte == '.' || byte == '[';
+}
+
 /// @details Tracks the parentheses with a stack, and counts the number
 /// of operation units so we know where to place an operator after every two
 /// units. An operation unit can be a single symbol or a parenthesized set of
 /// symbols/operators. Each parenthesized set of symbols/operators is treated
 /// as a single unit after being converted.
-char* re2post(const char* re) {
-  static char result[BUF_SIZE];
-
-  if (buf_may_overflow(re)) {
-    return NULL;
-  }
-
+///
+/// Besides the characters of re, the result only has a concatenation operator
+/// per unit, so the result and the stack are both sized by the length of re up
+/// front, which makes the conversion take linear time and memory. A counted
+/// repetition copies its operand, which grows the result by at most
+/// RE2POST_MAX_REPEAT_SIZE bytes in total. In UTF-8, a ., a bracket
+/// expression and a multibyte character are written out as well, which grows
+/// the result by their lengths.
+static char* convert(const char* re, bool is_utf8) {
+  const size_t len = strlen(re);
+  size_t capacity = len * 2 + 1;
+  char* result = malloc(capacity);
   char* result_tail = result;
+  size_t repeat_size = 0;
 
   /// @brief Stashing the nested parentheses units seen so far, so we
   /// can restore them after converting inner nested parenthesized units. Treat
-  /// the converted unit as a single unit, and resume the conversion.
-  Stack* paren_units = create_stack();
-  Unit* curr_paren_unit = malloc(sizeof(Unit));
-  init_unit(curr_paren_unit);
-
-#define FREE_HEAP_ALLOCATED_VARS()       \
-  free(curr_paren_unit);                 \
-  while (!is_empty_stack(paren_units)) { \
-    free((Unit*)pop_stack(paren_units)); \
-  }                                      \
-  delete_stack(paren_units);
+  /// the converted unit as a single unit, and resume the conversion. The
+  /// bottom one is the unit out of all parentheses.
+  Unit* paren_units = malloc(sizeof(Unit) * (len + 1));
+  Unit* curr_paren_unit = paren_units;
+  init_unit(curr_paren_unit, 0);
+
+  /// @brief The characters of a bracket expression or a multibyte character
+  /// in UTF-8, and the written . once seen.
+  CodePointSet* code_points = is_utf8 ? create_code_point_set() : NULL;
+  char* any = NULL;
+
+#define FAIL()                          \
+  free(paren_units);                    \
+  free(result);                         \
+  free(any);                            \
+  if (code_points) {                    \
+    delete_code_point_set(code_points); \
+  }                                     \
+  return NULL;
 
   for (; *re; re++) {
     switch (*re) {
@@ -87,85 +161,207 @@ char* re2post(const char* re) {
 
         // a new parenthesized unit is now about to start,
         // stash the current one and move on
-        push_stack(paren_units, curr_paren_unit);
-        curr_paren_unit = malloc(sizeof(Unit));
-        init_unit(curr_paren_unit);
+        curr_paren_unit++;
+        init_unit(curr_paren_unit, result_tail - result);
         break;
       case '|':
         if (!has_unit_to_operate(*curr_paren_unit)) {
-          FREE_HEAP_ALLOCATED_VARS();
-          return NULL;
+          FAIL();
         }
         // the previous concatenations are converted first
         // because union has lower precedence than concatenation,
         try_append_concat(curr_paren_unit, &result_tail);
 
         curr_paren_unit->num_of_union++;
+        curr_paren_unit->is_last_unit_dropped = false;
         break;
       case ')':
-        if (is_empty_stack(paren_units)
+        if (curr_paren_unit == paren_units
             || !has_unit_to_operate(*curr_paren_unit)) {
-          FREE_HEAP_ALLOCATED_VARS();
-          return NULL;
+          FAIL();
         }
 
         // The current unit is about to complete, append the awaiting operators.
         try_append_concat(curr_paren_unit, &result_tail);
         try_append_unions(curr_paren_unit, &result_tail);
+        if (curr_paren_unit->num_of_union != 0) {
+          FAIL();  // missing operand, e.g., of a dropped alternative
+        }
 
         // the current parenthesized unit is converted and becomes a single
         // unit. Restore the outer unit
-        free(curr_paren_unit);
-        curr_paren_unit = pop_stack(paren_units);
+        curr_paren_unit--;
         curr_paren_unit->num_of_unit++;
+        curr_paren_unit->last_unit_begin = (curr_paren_unit + 1)->begin;
+        curr_paren_unit->is_last_unit_dropped = false;
         break;
       case '*':
       case '+':
       case '?':
+        if (curr_paren_unit->is_last_unit_dropped) {
+          break;  // the empty string repeated is still the empty string
+        }
         if (!has_unit_to_operate(*curr_paren_unit)) {
-          FREE_HEAP_ALLOCATED_VARS();
-          return NULL;
+          FAIL();
         }
         // unary left-associative with highest precedence,
         // append right next to the previous unit
         *result_tail++ = *re;
         break;
+      case '.':
+        if (is_utf8) {
+          if (!any) {
+            code_points->size = 0;
+            insert_code_point_range(code_points, 0, MAX_CODE_POINT);
+            any = code_point_set2post(code_points);
+          }
+          result = append_written_operand(curr_paren_unit, any, result,
+                                          &result_tail, &capacity);
+        } else {
+          append_operand(curr_paren_unit, re, 1, result, &result_tail);
+        }
+        break;
+      case '[': {
+        if (is_utf8) {
+          const char* end = parse_code_point_set(re, code_points);
+          char* operand = end ? code_point_set2post(code_points) : NULL;
+          if (!operand) {
+            FAIL();  // ill-formed or of no characters
+          }
+          result = append_written_operand(curr_paren_unit, operand, result,
+                                          &result_tail, &capacity);
+          free(operand);
+          re = end - 1;
+          break;
+        }
+        // a bracket expression is a single unit, which is copied as is
+        ByteSet set;
+        const char* end = parse_byte_set(re, &set);
+        if (!end) {
+          FAIL();
+        }
+        append_operand(curr_paren_unit, re, end - re, result, &result_tail);
+        re = end - 1;
+      } break;
+      case '{': {
+        Bounds bounds;
+        const char* end = parse_bounds(re, &bounds);
+        if (!end) {
+          // not a counted repetition, so the brace is taken as is
+          append_operand(curr_paren_unit, re, 1, result, &result_tail);
+          break;
+        }
+        if (!are_valid_bounds(bounds)) {
+          FAIL();
+        }
+        if (curr_paren_unit->is_last_unit_dropped) {
+          re = end - 1;
+          break;  // the empty string repeated is still the empty string
+        }
+        if (!has_unit_to_operate(*curr_paren_unit)) {
+          FAIL();
+        }
+        if (bounds.max == 0) {
+          // the last unit is dropped, which is the last thing written since
+          // the concatenation joining it to the previous unit is appended
+          // only once another unit follows
+          result_tail = result + curr_paren_unit->last_unit_begin;
+          curr_paren_unit->num_of_unit--;
+          curr_paren_unit->is_last_unit_dropped = true;
+          re = end - 1;
+          break;
+        }
+        // the last unit is replaced with its repetition, which is written
+        // from a copy since the result may be moved on growing
+        const size_t operand_begin = curr_paren_unit->last_unit_begin;
+        const size_t operand_len = (result_tail - result) - operand_begin;
+        const size_t repetition_len = get_repetition_len(operand_len, bounds);
+        repeat_size += repetition_len - operand_len;
+        if (repeat_size > RE2POST_MAX_REPEAT_SIZE) {
+          FAIL();
+        }
+        char* operand = malloc(operand_len);
+        memcpy(operand, result + operand_begin, operand_len);
+        capacity += repetition_len - operand_len;
+        result = realloc(result, capacity);
+        result_tail = result + operand_begin;
+        write_repetition(operand, operand_len, bounds, &result_tail);
+        free(operand);
+        re = end - 1;
+      } break;
       default:
-        // the previous units are converted first
-        // because concatenation is left-associative
-        try_append_concat(curr_paren_unit, &result_tail);
-        *result_tail++ = *re;
-        curr_paren_unit->num_of_unit++;
+        if (is_utf8 && (unsigned char)*re >= 0x80) {
+          // a multibyte character is a single unit of its bytes
+          int code_point;
+          const int len = decode_utf8(re, &code_point);
+          if (!len) {
+            FAIL();
+          }
+          code_points->size = 0;
+          insert_code_point_range(code_points, code_point, code_point);
+          char* operand = code_point_set2post(code_points);
+          result = append_written_operand(curr_paren_unit, operand, result,
+                                          &result_tail, &capacity);
+          free(operand);
+          re += len - 1;
+          break;
+        }
+        append_operand(curr_paren_unit, re, 1, result, &result_tail);
         break;
     }
   }
-  if (!is_empty_stack(paren_units)) {
-    FREE_HEAP_ALLOCATED_VARS();
-    return NULL;  // unmatched parentheses
+  if (curr_paren_unit != paren_units) {
+    FAIL();  // unmatched parentheses
   }
   // The conversion is about to complete, append the awaiting operators.
   try_append_concat(curr_paren_unit, &result_tail);
   try_append_unions(curr_paren_unit, &result_tail);
 
   if (curr_paren_unit->num_of_union != 0) {
-    FREE_HEAP_ALLOCATED_VARS();
-    return NULL;  // missing operand
+    FAIL();  // missing operand
   }
+#undef FAIL
 
-  FREE_HEAP_ALLOCATED_VARS();
-
+  free(paren_units);
+  free(any);
+  if (code_points) {
+    delete_code_point_set(code_points);
+  }
   *result_tail = '\0';
   return result;
 }
 
-static void init_unit(Unit* unit) {
-  *unit = (Unit){.num_of_union = 0, .num_of_unit = 0};
+static void init_unit(Unit* unit, size_t begin) {
+  *unit = (Unit){.num_of_union = 0,
+                 .num_of_unit = 0,
+                 .begin = begin,
+                 .last_unit_begin = begin,
+                 .is_last_unit_dropped = false};
+}
+
+static void append_operand(Unit* unit, const char* operand, size_t len,
+                           const char* result_begin, char** result) {
+  // the previous units are converted first
+  // because concatenation is left-associative
+  try_append_concat(unit, result);
+  unit->last_unit_begin = *result - result_begin;
+  unit->is_last_unit_dropped = false;
+  memcpy(*result, operand, len);
+  *result += len;
+  unit->num_of_unit++;
 }
 
-static bool buf_may_overflow(const char* re) {
-  // the number of concat symbol can at most be strlen(re) - 1 when re contains
-  // only concatenations
-  return strlen(re) > BUF_SIZE / 2;
+static char* append_written_operand(Unit* unit, const char* operand,
+                                    char* result, char** result_tail,
+                                    size_t* capacity) {
+  const size_t len = strlen(operand);
+  const size_t size = *result_tail - result;
+  // besides the room of the character it's in place of
+  *capacity += len;
+  result = realloc(result, *capacity);
+  *result_tail = result + size;
+  append_operand(unit, operand, len, result, result_tail);
+  return result;
 }
 
 static void try_append_concat(Unit* unit, char** result) {
@@ -198,3 +394,105 @@ static bool has_units_to_union(Unit unit) {
   // binary operator needs at least 2 units
   return unit.num_of_union >= 1 && unit.num_of_unit >= 2;
 }
+
+/// @brief Parses the decimal number which s starts with, which saturates once
+/// it's above RE2POST_MAX_REPEAT.
+/// @return The end of the number; NULL if s doesn't start with a digit.
+static const char* parse_number(const char* s, int* n) {
+  if (*s < '0' || *s > '9') {
+    return NULL;
+  }
+  *n = 0;
+  for (; *s >= '0' && *s <= '9'; s++) {
+    if (*n <= RE2POST_MAX_REPEAT) {
+      *n = *n * 10 + (*s - '0');
+    }
+  }
+  return s;
+}
+
+static const char* parse_bounds(const char* s, Bounds* bounds) {
+  s = parse_number(s + 1, &bounds->min);
+  if (!s) {
+    return NULL;
+  }
+  bounds->max = bounds->min;
+  if (*s == ',') {
+    s++;
+    bounds->max = -1;
+    if (*s != '}') {
+      s = parse_number(s, &bounds->max);
+      if (!s) {
+        return NULL;
+      }
+    }
+  }
+  return *s == '}' ? s + 1 : NULL;
+}
+
+static bool are_valid_bounds(Bounds bounds) {
+  if (bounds.min > RE2POST_MAX_REPEAT || bounds.max > RE2POST_MAX_REPEAT) {
+    return false;
+  }
+  return bounds.max == -1 || bounds.min <= bounds.max;
+}
+
+static size_t get_repetition_len(size_t operand_len, Bounds bounds) {
+  // the required copies and a concatenation between each two of them
+  size_t len = (size_t)bounds.min * (operand_len + 1) - (bounds.min > 0);
+  if (bounds.max == -1) {
+    // a plus on the last copy, or a star on a copy of its own
+    return len + (bounds.min > 0 ? 1 : operand_len + 1);
+  }
+  // the optional copies, each with a question mark and a concatenation but
+  // the innermost, and the concatenation to the required ones
+  const size_t num_of_optional = bounds.max - bounds.min;
+  if (num_of_optional) {
+    len += num_of_optional * (operand_len + 2) - 1 + (bounds.min > 0);
+  }
+  return len;
+}
+
+/// @details The optional copies are nested, as in (x(x(x)?)?)?, rather than
+/// concatenated, as in x?x?x?, so that each of them only follows the previous
+/// one, which keeps the number of transitions linear in the number of copies.
+static void write_repetition(const char* operand, size_t operand_len,
+                             Bounds bounds, char** result) {
+#define WRITE_OPERAND()                    \
+  memcpy(*result, operand, operand_len); \
+  *result += operand_len;
+#define WRITE(c) (*(*result)++ = (c))
+
+  for (int i = 0; i < bounds.min; i++) {
+    WRITE_OPERAND();
+    if (bounds.max == -1 && i == bounds.min - 1) {
+      WRITE('+');
+    }
+    if (i > 0) {
+      WRITE(EXPLICIT_CONCAT);
+    }
+  }
+  if (bounds.max == -1) {
+    if (bounds.min == 0) {
+      WRITE_OPERAND();
+      WRITE('*');
+    }
+    return;
+  }
+  const int num_of_optional = bounds.max - bounds.min;
+  for (int i = 0; i < num_of_optional; i++) {
+    WRITE_OPERAND();
+  }
+  for (int i = 0; i < num_of_optional; i++) {
+    WRITE('?');
+    if (i < num_of_optional - 1) {
+      WRITE(EXPLICIT_CONCAT);
+    }
+  }
+  if (bounds.min > 0 && num_of_optional > 0) {
+    WRITE(EXPLICIT_CONCAT);
+  }
+
+#undef WRITE
+#undef WRITE_OPERAND
+}
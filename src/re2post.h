@@ -10,17 +10,54 @@ https://opensource.org/license/mit/.
 #ifndef RE2POST_H
 #define RE2POST_H
 
+#include <stdbool.h>
+
 #ifndef EXPLICIT_CONCAT
 #define EXPLICIT_CONCAT '#'
 #endif
 
+#ifndef RE2POST_MAX_REPEAT
+/// @brief Define before including this file if you want to use another cap on
+/// the bounds of a counted repetition.
+#define RE2POST_MAX_REPEAT 1000
+#endif
+
+#ifndef RE2POST_MAX_REPEAT_SIZE
+/// @brief Define before including this file if you want to use another cap on
+/// the total number of bytes the counted repetitions add to the postfix form,
+/// which bounds the number of states they add.
+#define RE2POST_MAX_REPEAT_SIZE (1 << 16)
+#endif
+
 /// @brief Converts infix regexp re to postfix notation.
 /// Inserts . as explicit concatenation operator.
-/// Cheesy parser, returns static buffer.
-/// @return The postfix form of re; NULL if its ill-formed of too long.
+/// A bracket expression, such as [a-z] or [^0-9], is a single operand, which
+/// is copied as is; see parse_byte_set.
+/// A counted repetition, which is one of {n}, {n,} and {n,m}, is written out
+/// as copies of its operand, e.g., a{2,3} as aa#a?#, and drops its operand if
+/// it's {0} or {0,0}; a { which doesn't start one is taken as is.
+/// @return The postfix form of re; NULL if it's ill-formed, or if a counted
+/// repetition is beyond RE2POST_MAX_REPEAT or the copies take more than
+/// RE2POST_MAX_REPEAT_SIZE bytes.
 /// @note Associative Property holds for concatenation and union operator, the
 /// postfix notation isn't unique. This function has concatenation and union
 /// operator be left and right-associative, respectively.
+/// @note Should be freed after use with free.
 char* re2post(const char* re);
 
+/// @brief Converts infix regexp re, which is in UTF-8, to postfix notation in
+/// the same way as re2post does, but a . and a bracket expression match a
+/// character, rather than a byte, and so does a multibyte character under a
+/// repetition. Each of them is written out as the union of the byte sequences
+/// of its characters; see code_point_set2post.
+/// @return The postfix form of re; NULL if it's ill-formed, which is also the
+/// case if it isn't well-formed UTF-8.
+/// @note Should be freed after use with free.
+char* re2post_utf8(const char* re);
+
+/// @return Whether the byte is taken as other than itself in postfix, which
+/// the null byte also is since it ends the string. Such a byte is written as a
+/// bracket expression to be taken as itself.
+bool is_operator_byte(unsigned char);
+
 #endif /* end of include guard: RE2POST_H */
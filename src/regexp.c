@@ -1,61 +1,461 @@
 #include "regexp.h"
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "ast.h"
+#include "bitvm.h"
+#include "byteclass.h"
 #include "cache.h"
+#include "dfa.h"
+#include "glushkov.h"
+#include "literal.h"
 #include "map.h"
+#include "pikevm.h"
 #include "post2nfa.h"
+#include "prog.h"
 #include "re2post.h"
+#include "scratch.h"
+#include "shiftand.h"
 #include "stack.h"
 
-/// @return The epsilon closure from start.
-static Map* get_start_states(State* start);
-
-/// @details Simulates the NFA by moving between the possible set of states.
-/// If the accepting state is in the set after the last input character is
-/// consumed, the NFA accepts the string.
-bool is_accepted(const Nfa* nfa, const char* s) {
-  Map* states = get_start_states(nfa->start);
-  for (; *s; s++) {
-    Map* next_states = get_next_states(states, *s);
-    delete_map(states);
-    states = next_states;
-  }
-  /// Thompson's algorithm proves that: For any regular language L, there is
-  /// an NFA that accepts L that has exactly one accepting state t, which is
-  /// distinct from the starting state s.
-  /// See
-  /// https://courses.engr.illinois.edu/cs374/fa2018/notes/models/04-nfa.pdf.
-  const bool accepted = get_value(states, nfa->accept->id);
-  delete_map(states);
+/// @return Whether the accepting state is in the DFA state after the last
+/// input character is consumed.
+/// @note The DFA states built during the simulation are kept in the cache.
+static bool simulate_with_cache(DfaCache* cache, const char* s, size_t len) {
+  return feed_dfa_cache(cache, get_start_dstate(cache), s, len)->accepting;
+}
+
+/// @details Simulates the program of the NFA by moving between the possible
+/// set of states. If the accepting state is in the set after the last input
+/// character is consumed, the NFA accepts the string.
+bool is_accepted(const Nfa* nfa, const char* s, size_t len) {
+  Prog* prog = create_prog(nfa);
+  PikeVm* vm = create_pike_vm(prog);
+  const bool accepted = run_pike_vm(vm, s, len);
+  delete_pike_vm(vm);
+  delete_prog(prog);
   return accepted;
 }
 
-bool is_accepted_with_cache(const Nfa* nfa, const char* s) {
-  /// Caching the ids of the DFA states.
-  Map* cache_table = create_map();
-  DfaState* curr_dstate = create_dfa_state(get_start_states(nfa->start));
-  cache_dstate(cache_table, curr_dstate);
-  for (; *s; s++) {
-    if (!has_cache(cache_table, curr_dstate, *s)) {
-      DfaState* next_dstate
-          = create_dfa_state(get_next_states(curr_dstate->states, *s));
-      cache_dstate(cache_table, next_dstate);
-      curr_dstate->next[(int)*s] = next_dstate->id;
-    }
-    curr_dstate = get_value(cache_table, curr_dstate->next[(int)*s]);
-  }
+bool is_accepted_with_cache(const Nfa* nfa, const char* s, size_t len) {
+  Prog* prog = create_prog(nfa);
+  ByteClasses classes;
+  compute_byte_classes(prog, &classes);
+  DfaCache* cache = create_dfa_cache(prog, &classes, 0);
 
-  const bool accepted = get_value(curr_dstate->states, nfa->accept->id);
+  const bool accepted = simulate_with_cache(cache, s, len);
 
   // delete all the DFA states
-  FOR_EACH_ITR(cache_table, itr, delete_dfa_state(get_current_value(itr)));
-  delete_map(cache_table);
+  delete_dfa_cache(cache);
+  delete_prog(prog);
 
   return accepted;
 }
 
+bool is_accepted_with_shift_and(const Nfa* nfa, const char* s, size_t len) {
+  Prog* prog = create_prog(nfa);
+  ShiftAnd* shift_and = create_shift_and(prog);
+  if (!shift_and) {
+    delete_prog(prog);
+    return is_accepted(nfa, s, len);
+  }
+
+  const bool accepted = run_shift_and(shift_and, s, len);
+
+  delete_shift_and(shift_and);
+  delete_prog(prog);
+  return accepted;
+}
+
+void init_regexp_options(RegexpOptions* options) {
+  options->cache = false;
+  options->cache_budget = 0;
+  options->dfa = false;
+  options->dfa_max_states = DFA_MAX_STATES;
+  options->glushkov = false;
+  options->simplify = true;
+  options->utf8 = false;
+  options->search = false;
+}
+
+enum {
+  /// @brief The maximum number of bytes of the literal, beyond which a longer
+  /// one hardly rules out more strings.
+  MAX_LITERAL_LEN = 32,
+};
+
+struct Regexp {
+  /// @brief NULL if compiled with Glushkov's construction.
+  Nfa* nfa;
+  /// @brief The NFA lowered into a program with dense ids, or the position
+  /// automaton.
+  Prog* prog;
+  /// @brief The bytes which the DFAs don't have to tell apart.
+  ByteClasses classes;
+  /// @brief The bit-parallel matcher; NULL if the program has too many
+  /// positions, caching or with the full DFA.
+  ShiftAnd* shift_and;
+  /// @brief The transitions of the program as bitsets, which take the place
+  /// of the bit-parallel matcher if the program has too many positions; NULL
+  /// if the program is too large, caching or with the full DFA.
+  BitProg* bit_prog;
+  /// @brief The DFA states built so far; NULL if not caching.
+  DfaCache* cache;
+  /// @brief The budget of the cache, which the caches of the matchers have
+  /// too.
+  size_t cache_budget;
+  /// @brief The minimized full DFA; NULL if not built.
+  Dfa* dfa;
+  /// @brief The workspace of match_regexp; NULL if caching or no workspace is
+  /// needed.
+  RegexpScratch* scratch;
+  /// @brief The number of states of the full DFA before minimization.
+  int num_of_unminimized_dfa_states;
+  /// @brief The bytes every string accepted contains; none if literal_len is
+  /// 0.
+  char literal[MAX_LITERAL_LEN];
+  size_t literal_len;
+};
+
+struct RegexpScratch {
+  /// @brief The simulation of the program with bitsets; NULL if the program
+  /// is too large for bitsets.
+  BitVm* bit_vm;
+  /// @brief The simulation of the program with sparse sets, which takes the
+  /// place of the bitsets.
+  PikeVm* vm;
+};
+
+/// @brief Builds the minimized full DFA of the regexp.
+/// @return Whether the DFA is built, which fails if it has too many states.
+static bool try_build_dfa(Regexp* regexp, size_t max_states) {
+  Dfa* dfa = build_dfa(regexp->prog, &regexp->classes, max_states);
+  if (!dfa) {
+    return false;
+  }
+  regexp->num_of_unminimized_dfa_states = dfa->num_of_states;
+  regexp->dfa = minimize_dfa(dfa);
+  delete_dfa(dfa);
+  return true;
+}
+
+Regexp* compile_regexp(const char* re, const RegexpOptions* options) {
+  RegexpOptions default_options;
+  if (!options) {
+    init_regexp_options(&default_options);
+    options = &default_options;
+  }
+
+  char* post = options->utf8 ? re2post_utf8(re) : re2post(re);
+  if (post && options->simplify) {
+    char* simplified
+        = options->search ? simplify_search_post(post) : simplify_post(post);
+    free(post);
+    post = simplified;
+  }
+  if (!post) {
+    return NULL;
+  }
+  char literal[MAX_LITERAL_LEN];
+  const size_t literal_len
+      = find_post_required_literal(post, literal, MAX_LITERAL_LEN);
+  Nfa* nfa = NULL;
+  Prog* prog = NULL;
+  if (options->glushkov) {
+    prog = post2glushkov(post);
+  }
+  // falls back to Thompson's construction if the follows are too large
+  if (!prog) {
+    nfa = post2nfa(post);
+    prog = nfa ? create_prog(nfa) : NULL;
+  }
+  free(post);
+  if (!prog) {
+    return NULL;
+  }
+  // the engines are built from the program, so they all search
+  prog->unanchored = options->search;
+
+  Regexp* regexp = malloc(sizeof(Regexp));
+  regexp->nfa = nfa;
+  regexp->prog = prog;
+  regexp->shift_and = NULL;
+  regexp->bit_prog = NULL;
+  regexp->cache = NULL;
+  regexp->cache_budget = options->cache_budget;
+  regexp->dfa = NULL;
+  regexp->scratch = NULL;
+  regexp->num_of_unminimized_dfa_states = 0;
+  memcpy(regexp->literal, literal, literal_len);
+  regexp->literal_len = literal_len;
+  compute_byte_classes(regexp->prog, &regexp->classes);
+  if (options->dfa && try_build_dfa(regexp, options->dfa_max_states)) {
+    return regexp;
+  }
+  // falls back to the cache if the full DFA is too large
+  if (options->cache || options->dfa) {
+    regexp->cache = create_dfa_cache(regexp->prog, &regexp->classes,
+                                     options->cache_budget);
+    // the start DFA state is always needed, which is kept on flushes
+    get_start_dstate(regexp->cache);
+  } else {
+    // the engines are tried from the fastest to the most general
+    regexp->shift_and = create_shift_and(regexp->prog);
+    if (!regexp->shift_and) {
+      regexp->bit_prog = create_bit_prog(regexp->prog, &regexp->classes);
+    }
+    const size_t scratch_size = get_regexp_scratch_size(regexp);
+    if (scratch_size) {
+      regexp->scratch = init_regexp_scratch(regexp, malloc(scratch_size));
+    }
+  }
+  return regexp;
+}
+
+void delete_regexp(Regexp* regexp) {
+  if (regexp->dfa) {
+    delete_dfa(regexp->dfa);
+  } else if (regexp->cache) {
+    delete_dfa_cache(regexp->cache);
+  } else if (regexp->shift_and) {
+    delete_shift_and(regexp->shift_and);
+  } else if (regexp->bit_prog) {
+    delete_bit_prog(regexp->bit_prog);
+  }
+  // the workspace is at the beginning of its memory
+  free(regexp->scratch);
+  delete_prog(regexp->prog);
+  if (regexp->nfa) {
+    delete_nfa(regexp->nfa);
+  }
+  free(regexp);
+}
+
+/// @return The masks the program is simulated with in a workspace; NULL if
+/// the program is simulated with sparse sets.
+static BitProg* get_scratch_bit_prog(const Regexp* regexp) {
+  if (regexp->bit_prog) {
+    return regexp->bit_prog;
+  }
+  return regexp->cache ? regexp->cache->bit_prog : NULL;
+}
+
+/// @return Whether the regexp is matched with tables which are never modified
+/// on matching.
+static bool is_matched_without_scratch(const Regexp* regexp) {
+  return regexp->dfa || regexp->shift_and;
+}
+
+size_t get_regexp_scratch_size(const Regexp* regexp) {
+  if (is_matched_without_scratch(regexp)) {
+    return 0;
+  }
+  const BitProg* bit_prog = get_scratch_bit_prog(regexp);
+  return get_scratch_size(sizeof(RegexpScratch))
+         + (bit_prog ? get_bit_vm_size(bit_prog)
+                     : get_pike_vm_size(regexp->prog));
+}
+
+RegexpScratch* init_regexp_scratch(const Regexp* regexp, void* memory) {
+  if (is_matched_without_scratch(regexp)) {
+    return NULL;
+  }
+  Scratch scratch;
+  init_scratch(&scratch, memory);
+  RegexpScratch* regexp_scratch = take_scratch(&scratch, sizeof(RegexpScratch));
+  BitProg* bit_prog = get_scratch_bit_prog(regexp);
+  regexp_scratch->bit_vm = NULL;
+  regexp_scratch->vm = NULL;
+  if (bit_prog) {
+    regexp_scratch->bit_vm = init_bit_vm(
+        take_scratch(&scratch, get_bit_vm_size(bit_prog)), bit_prog);
+  } else {
+    regexp_scratch->vm = init_pike_vm(
+        take_scratch(&scratch, get_pike_vm_size(regexp->prog)), regexp->prog);
+  }
+  return regexp_scratch;
+}
+
+/// @return Whether the string lacks the literal of the regexp, so it can't be
+/// accepted. The literal is only looked for in a search, which would go over
+/// the whole of a string that isn't accepted anyway.
+static bool lacks_literal(const Regexp* regexp, const char* s, size_t len) {
+  return regexp->prog->unanchored && regexp->literal_len
+         && find_literal(s, s + len, regexp->literal, regexp->literal_len)
+                == s + len;
+}
+
+bool match_regexp_with_scratch(const Regexp* regexp, RegexpScratch* scratch,
+                               const char* s, size_t len) {
+  if (lacks_literal(regexp, s, len)) {
+    return false;
+  }
+  if (regexp->dfa) {
+    return is_accepted_by_dfa(regexp->dfa, s, len);
+  }
+  if (regexp->shift_and) {
+    return run_shift_and(regexp->shift_and, s, len);
+  }
+  if (scratch->bit_vm) {
+    return run_bit_vm(scratch->bit_vm, s, len);
+  }
+  return run_pike_vm(scratch->vm, s, len);
+}
+
+bool match_regexp(Regexp* regexp, const char* s) {
+  return match_regexp_n(regexp, s, strlen(s));
+}
+
+bool match_regexp_n(Regexp* regexp, const char* s, size_t len) {
+  if (regexp->cache) {
+    return !lacks_literal(regexp, s, len)
+           && simulate_with_cache(regexp->cache, s, len);
+  }
+  return match_regexp_with_scratch(regexp, regexp->scratch, s, len);
+}
+
+struct RegexpMatcher {
+  const Regexp* regexp;
+  /// @brief The DFA states built by the matcher; NULL if the regexp doesn't
+  /// cache.
+  DfaCache* cache;
+  /// @brief NULL if caching or no workspace is needed.
+  RegexpScratch* scratch;
+};
+
+RegexpMatcher* create_regexp_matcher(const Regexp* regexp) {
+  RegexpMatcher* matcher = malloc(sizeof(RegexpMatcher));
+  matcher->regexp = regexp;
+  matcher->cache = NULL;
+  matcher->scratch = NULL;
+  if (regexp->cache) {
+    matcher->cache = create_dfa_cache(regexp->prog, &regexp->classes,
+                                      regexp->cache_budget);
+    get_start_dstate(matcher->cache);
+  } else {
+    const size_t scratch_size = get_regexp_scratch_size(regexp);
+    if (scratch_size) {
+      matcher->scratch = init_regexp_scratch(regexp, malloc(scratch_size));
+    }
+  }
+  return matcher;
+}
+
+void delete_regexp_matcher(RegexpMatcher* matcher) {
+  if (matcher->cache) {
+    delete_dfa_cache(matcher->cache);
+  }
+  // the workspace is at the beginning of its memory
+  free(matcher->scratch);
+  free(matcher);
+}
+
+bool match_regexp_with_matcher(RegexpMatcher* matcher, const char* s,
+                               size_t len) {
+  if (matcher->cache) {
+    return !lacks_literal(matcher->regexp, s, len)
+           && simulate_with_cache(matcher->cache, s, len);
+  }
+  return match_regexp_with_scratch(matcher->regexp, matcher->scratch, s, len);
+}
+
+struct RegexpStream {
+  Regexp* regexp;
+  /// @brief The state of whichever automaton the regexp is matched with; the
+  /// VMs keep theirs in the scratch of the regexp.
+  int dfa_state;
+  DfaState* dstate;
+  uint64_t positions;
+};
+
+RegexpStream* create_regexp_stream(Regexp* regexp) {
+  RegexpStream* stream = malloc(sizeof(RegexpStream));
+  stream->regexp = regexp;
+  if (regexp->dfa) {
+    stream->dfa_state = regexp->dfa->start;
+  } else if (regexp->cache) {
+    stream->dstate = get_start_dstate(regexp->cache);
+  } else if (regexp->shift_and) {
+    stream->positions = regexp->shift_and->start;
+  } else if (regexp->scratch->bit_vm) {
+    start_bit_vm(regexp->scratch->bit_vm);
+  } else {
+    start_pike_vm(regexp->scratch->vm);
+  }
+  return stream;
+}
+
+void delete_regexp_stream(RegexpStream* stream) {
+  free(stream);
+}
+
+/// @details Once no string that starts with the bytes fed is accepted, the
+/// automata stop at the first byte of each chunk.
+void feed_regexp_stream(RegexpStream* stream, const char* s, size_t len) {
+  Regexp* regexp = stream->regexp;
+  if (regexp->dfa) {
+    stream->dfa_state = feed_dfa(regexp->dfa, stream->dfa_state, s, len);
+  } else if (regexp->cache) {
+    stream->dstate = feed_dfa_cache(regexp->cache, stream->dstate, s, len);
+  } else if (regexp->shift_and) {
+    stream->positions
+        = feed_shift_and(regexp->shift_and, stream->positions, s, len);
+  } else if (regexp->scratch->bit_vm) {
+    feed_bit_vm(regexp->scratch->bit_vm, s, len);
+  } else {
+    feed_pike_vm(regexp->scratch->vm, s, len);
+  }
+}
+
+bool finish_regexp_stream(const RegexpStream* stream) {
+  const Regexp* regexp = stream->regexp;
+  if (regexp->dfa) {
+    return regexp->dfa->accepting[stream->dfa_state];
+  }
+  if (regexp->cache) {
+    return stream->dstate->accepting;
+  }
+  if (regexp->shift_and) {
+    return stream->positions & regexp->shift_and->accept;
+  }
+  if (regexp->scratch->bit_vm) {
+    return is_bit_vm_accepting(regexp->scratch->bit_vm);
+  }
+  return is_pike_vm_accepting(regexp->scratch->vm);
+}
+
+const Nfa* get_regexp_nfa(const Regexp* regexp) {
+  return regexp->nfa;
+}
+
+const Prog* get_regexp_prog(const Regexp* regexp) {
+  return regexp->prog;
+}
+
+const char* get_regexp_literal(const Regexp* regexp, size_t* len) {
+  *len = regexp->literal_len;
+  return regexp->literal_len ? regexp->literal : NULL;
+}
+
+void get_regexp_stats(const Regexp* regexp, RegexpStats* stats) {
+  *stats = (RegexpStats){0};
+  if (regexp->cache) {
+    stats->num_of_dstates = regexp->cache->num_of_dstates;
+    stats->cache_memory = regexp->cache->memory_used;
+    stats->num_of_flushes = regexp->cache->num_of_flushes;
+    stats->num_of_evictions = regexp->cache->num_of_evictions;
+  }
+  if (regexp->dfa) {
+    stats->num_of_dfa_states = regexp->dfa->num_of_states;
+    stats->num_of_unminimized_dfa_states
+        = regexp->num_of_unminimized_dfa_states;
+  }
+}
+
 Map* epsilon_closure(Map* start) {
   Stack* to_reach_out = create_stack();
 
@@ -84,14 +484,14 @@ Map* move(Map* from, char c) {
   Map* outs = create_map();
   FOR_EACH_ITR(from, itr, {
     State* s = get_current_value(itr);
-    if (s->label == c || s->label == ANY) {
+    if (state_takes(s, c)) {
       insert_pair(outs, s->outs[0]->id, s->outs[0]);
     }
   });
   return outs;
 }
 
-static Map* get_start_states(State* start) {
+Map* get_start_states(State* start) {
   Map* start_states = create_map();
   insert_pair(start_states, start->id, start);
   Map* tmp = epsilon_closure(start_states);
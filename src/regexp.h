@@ -2,17 +2,183 @@
 #define REGEXP_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "map.h"
 #include "post2nfa.h"
+#include "prog.h"
 
-/// @return Whether the string is accepted by the NFA.
+/// @brief The options on how a regexp is compiled and matched.
+typedef struct RegexpOptions {
+  /// @brief Whether to cache the NFA states to build a DFA on the fly.
+  bool cache;
+  /// @brief The maximum number of bytes the cached DFA states may take; 0 if
+  /// unlimited. The cache is flushed once the budget is exceeded.
+  size_t cache_budget;
+  /// @brief Whether to build the full DFA and minimize it ahead of time. Falls
+  /// back to caching if the DFA has more than dfa_max_states states.
+  bool dfa;
+  size_t dfa_max_states;
+  /// @brief Whether to compile the regexp with Glushkov's construction instead
+  /// of Thompson's, which has no epsilon transitions, so no NFA is kept. Falls
+  /// back to Thompson's if the follows would take more than
+  /// PROG_MAX_FOLLOW_IDS ids.
+  bool glushkov;
+  /// @brief Whether to simplify the parse tree of the regexp before the
+  /// automaton is built from it, which matches the same strings with fewer
+  /// states.
+  bool simplify;
+  /// @brief Whether the regexp and the strings are in UTF-8, so that a . and a
+  /// bracket expression match a character rather than a byte. The characters
+  /// are compiled into byte sequences, so the strings are never decoded; a
+  /// string that isn't well-formed UTF-8 simply doesn't match where it isn't.
+  bool utf8;
+  /// @brief Whether the regexp is searched for in the strings rather than
+  /// matched against the whole of them, so a string is accepted if any of its
+  /// substrings is. The automata start over at every byte and stop at the
+  /// first match, and a .* at either end of the regexp is dropped.
+  bool search;
+} RegexpOptions;
+
+/// @brief Sets the default options, which simulates the program of the
+/// simplified NFA without caching.
+void init_regexp_options(RegexpOptions*);
+
+/// @brief A compiled regular expression. It owns the NFA, the program lowered
+/// from the NFA, the sets of states to simulate the program with and, if
+/// caching, the DFA built so far, which persists across matches so that the
+/// work done on one string helps the next. It may own the full DFA instead,
+/// which matches with a table lookup per character.
+typedef struct Regexp Regexp;
+
+/// @param options NULL to use the default options.
+/// @return The compiled regexp; NULL if re is ill-formed.
+/// @note Should be freed after use with delete_regexp.
+Regexp* compile_regexp(const char* re, const RegexpOptions* options);
+
+/// @brief Frees the regexp compiled previously with compile_regexp.
+void delete_regexp(Regexp*);
+
+/// @return Whether the null-terminated string is accepted by the regexp.
+/// @note The DFA states built and the lists of states simulated are kept in the
+/// regexp, so a regexp is matched by a single thread at a time.
+bool match_regexp(Regexp*, const char* s);
+
+/// @return Whether the len bytes of s are accepted by the regexp. They may
+/// have any value, null bytes included, and need no terminator, so a slice of
+/// a larger buffer is matched in place.
+/// @note As with match_regexp, a regexp is matched by a single thread at a
+/// time.
+bool match_regexp_n(Regexp*, const char* s, size_t len);
+
+/// @brief A string which is matched as it's fed in chunks, such as one read
+/// from a pipe or a socket. Only the state of the automaton is carried from a
+/// chunk to the next, so a string of any length is matched in constant memory.
+typedef struct RegexpStream RegexpStream;
+
+/// @brief Starts matching a string with the regexp, whose bytes are then fed
+/// in order with feed_regexp_stream.
+/// @note The stream matches in the DFA states and the lists of states kept in
+/// the regexp, so the regexp is neither matched nor streamed otherwise until
+/// the stream is deleted. Should be freed after use with delete_regexp_stream.
+RegexpStream* create_regexp_stream(Regexp*);
+
+void delete_regexp_stream(RegexpStream*);
+
+/// @brief Feeds the len bytes of s, which may have any value, null bytes
+/// included, as the continuation of the string fed so far.
+void feed_regexp_stream(RegexpStream*, const char* s, size_t len);
+
+/// @return Whether the string fed so far is accepted by the regexp.
+/// @note The stream can still be fed afterwards.
+bool finish_regexp_stream(const RegexpStream*);
+
+/// @brief The workspace a regexp is matched in, which lives in memory of the
+/// caller. A compiled regexp can thus be shared by threads with a workspace
+/// each.
+typedef struct RegexpScratch RegexpScratch;
+
+/// @return The number of bytes of the workspace the regexp is matched in; 0 if
+/// it needs none.
+size_t get_regexp_scratch_size(const Regexp*);
+
+/// @brief Lays out the workspace of the regexp in the memory, which has room
+/// for get_regexp_scratch_size bytes and is aligned as malloc'd memory is.
+/// @return The workspace; NULL if the regexp needs none.
+/// @note The memory is owned by the caller. The workspace can be reused by any
+/// number of matches of the regexp, one at a time.
+RegexpScratch* init_regexp_scratch(const Regexp*, void* memory);
+
+/// @return Whether the len bytes of s, which may have any value, null bytes
+/// included, are accepted by the regexp.
+/// @details Makes no allocation and never modifies the regexp. A regexp which
+/// caches the DFA states simulates its program instead, since the cache grows
+/// on matching.
+bool match_regexp_with_scratch(const Regexp*, RegexpScratch*, const char* s,
+                               size_t len);
+
+/// @brief What a thread needs to match a regexp shared with other threads: a
+/// DFA cache of its own if the regexp caches the DFA states, or else a
+/// workspace. The compiled program is only read, so any number of matchers
+/// match the same regexp at once.
+typedef struct RegexpMatcher RegexpMatcher;
+
+/// @note The regexp has to outlive the matcher. Should be freed after use
+/// with delete_regexp_matcher.
+RegexpMatcher* create_regexp_matcher(const Regexp*);
+
+void delete_regexp_matcher(RegexpMatcher*);
+
+/// @return Whether the len bytes of s, which may have any value, null bytes
+/// included, are accepted by the regexp of the matcher.
+/// @note The DFA states built persist across the matches of the matcher, as
+/// they do with match_regexp_n, but aren't shared with the regexp or other
+/// matchers.
+bool match_regexp_with_matcher(RegexpMatcher*, const char* s, size_t len);
+
+/// @return The NFA; NULL if compiled with Glushkov's construction.
+/// @note The NFA is owned by the regexp.
+const Nfa* get_regexp_nfa(const Regexp*);
+
+/// @note The program is owned by the regexp.
+const Prog* get_regexp_prog(const Regexp*);
+
+/// @return The bytes which every string accepted by the regexp contains, such
+/// as ERROR in .*ERROR.*, whose number is set to len; NULL if none is known.
+/// A search rejects the strings without them before any automaton runs.
+/// @note The literal is owned by the regexp.
+const char* get_regexp_literal(const Regexp*, size_t* len);
+
+/// @brief The statistics of the DFAs of a regexp, which are 0 if the
+/// regexp doesn't have the corresponding DFA.
+typedef struct RegexpStats {
+  /// @brief The number of states in the DFA cache.
+  size_t num_of_dstates;
+  /// @brief The number of bytes the cached DFA states take.
+  size_t cache_memory;
+  size_t num_of_flushes;
+  /// @brief The number of DFA states evicted by the flushes.
+  size_t num_of_evictions;
+  /// @brief The number of states of the minimized full DFA.
+  size_t num_of_dfa_states;
+  size_t num_of_unminimized_dfa_states;
+} RegexpStats;
+
+void get_regexp_stats(const Regexp*, RegexpStats* stats);
+
+/// @return Whether the len bytes of s, which may have any value, null bytes
+/// included, are accepted by the NFA.
 /// @details Simulates the NFA.
-bool is_accepted(const Nfa*, const char*);
+bool is_accepted(const Nfa*, const char* s, size_t len);
 
-/// @return Whether the string is accepted by the NFA.
+/// @return Whether the len bytes of s are accepted by the NFA.
 /// @note Caches the states to build a DFA on the fly.
-bool is_accepted_with_cache(const Nfa* nfa, const char* s);
+bool is_accepted_with_cache(const Nfa* nfa, const char* s, size_t len);
+
+/// @return Whether the len bytes of s are accepted by the NFA.
+/// @note Matches bit-parallel if the NFA has at most SHIFT_AND_MAX_POSITIONS
+/// labeled and accepting states; simulates the NFA otherwise.
+bool is_accepted_with_shift_and(const Nfa* nfa, const char* s, size_t len);
 
 /// @return The states that are reachable from start with only epsilon
 /// transitions, including all of the start states itself.
@@ -22,6 +188,9 @@ Map* epsilon_closure(Map* start);
 /// c with non-epsilon moves.
 Map* move(Map*, char c);
 
+/// @return The epsilon closure from start.
+Map* get_start_states(State* start);
+
 /// @return The states reachable from the current states on label c with epsilon
 /// moves.
 Map* get_next_states(Map* current_states, char c);
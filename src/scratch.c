@@ -0,0 +1,20 @@
+#include "scratch.h"
+
+#include <stddef.h>
+
+/// @brief The alignment of every piece, which suits any type.
+enum { SCRATCH_ALIGNMENT = 16 };
+
+size_t get_scratch_size(size_t size) {
+  return (size + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+}
+
+void init_scratch(Scratch* scratch, void* memory) {
+  scratch->next = memory;
+}
+
+void* take_scratch(Scratch* scratch, size_t size) {
+  void* piece = scratch->next;
+  scratch->next += get_scratch_size(size);
+  return piece;
+}
@@ -0,0 +1,24 @@
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include <stddef.h>
+
+/// @brief Carves pieces out of a block of memory supplied by the caller, as an
+/// arena does but without ever allocating, so the structures a match works on
+/// can live in a workspace of the caller.
+typedef struct Scratch {
+  unsigned char* next;
+} Scratch;
+
+/// @return The number of bytes a piece of size bytes takes, which keeps the
+/// next piece aligned for any type.
+size_t get_scratch_size(size_t size);
+
+/// @param memory Suitably aligned for any type, as the memory from malloc is.
+void init_scratch(Scratch*, void* memory);
+
+/// @return The next piece of size bytes.
+/// @note The memory has to have room for get_scratch_size(size) more bytes.
+void* take_scratch(Scratch*, size_t size);
+
+#endif /* end of include guard: SCRATCH_H */
@@ -0,0 +1,107 @@
+#include "shiftand.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "byteclass.h"
+#include "prog.h"
+#include "sparseset.h"
+#include "state.h"
+
+/// @return The positions of the important instructions in the set.
+static uint64_t get_positions(const SparseSet* reached,
+                              const int* position_of) {
+  uint64_t positions = 0;
+  for (int i = 0; i < reached->size; i++) {
+    const int position = position_of[reached->dense[i]];
+    if (position != -1) {
+      positions |= (uint64_t)1 << position;
+    }
+  }
+  return positions;
+}
+
+/// @details The important instructions are numbered as positions in the order
+/// of their ids.
+ShiftAnd* create_shift_and(const Prog* prog) {
+  const int n = prog->num_of_insts;
+  int* position_of = malloc(sizeof(int) * n);
+  int num_of_positions = 0;
+  for (int i = 0; i < n; i++) {
+    position_of[i]
+        = is_important_inst(&prog->insts[i]) ? num_of_positions++ : -1;
+  }
+  if (num_of_positions > SHIFT_AND_MAX_POSITIONS) {
+    free(position_of);
+    return NULL;
+  }
+
+  ShiftAnd* shift_and = calloc(1, sizeof(ShiftAnd));
+  shift_and->accept = (uint64_t)1 << position_of[prog->accept];
+  shift_and->num_of_chunks
+      = (num_of_positions + SHIFT_AND_CHUNK_BITS - 1) / SHIFT_AND_CHUNK_BITS;
+  SparseSet* reached = create_sparse_set(n);
+  int* stack = malloc(sizeof(int) * n);
+  add_initial(prog, reached, stack);
+  shift_and->start = get_positions(reached, position_of);
+  if (prog->unanchored) {
+    shift_and->restart = shift_and->start;
+    shift_and->found = shift_and->accept;
+  }
+  // the follow of each single position, from which the chunks are built
+  uint64_t follow[SHIFT_AND_MAX_POSITIONS] = {0};
+  for (int i = 0; i < n; i++) {
+    const Inst* inst = &prog->insts[i];
+    if (position_of[i] == -1 || inst->label == ACCEPT) {
+      continue;
+    }
+    const uint64_t bit = (uint64_t)1 << position_of[i];
+    for (int b = 0; b < NUM_OF_BYTES; b++) {
+      if (inst_takes(prog, inst, (char)b)) {
+        shift_and->takes[b] |= bit;
+      }
+    }
+    clear_sparse_set(reached);
+    add_follow(prog, i, reached, stack);
+    follow[position_of[i]] = get_positions(reached, position_of);
+  }
+  free(stack);
+  delete_sparse_set(reached);
+  free(position_of);
+
+  for (int k = 0; k < shift_and->num_of_chunks; k++) {
+    uint64_t* follows = shift_and->follows[k];
+    // each value is the follow of its lowest bit plus the value without it
+    for (int x = 1; x < 1 << SHIFT_AND_CHUNK_BITS; x++) {
+      const int lowest = __builtin_ctz(x);
+      follows[x] = follows[x & (x - 1)]
+                   | follow[k * SHIFT_AND_CHUNK_BITS + lowest];
+    }
+  }
+  return shift_and;
+}
+
+void delete_shift_and(ShiftAnd* shift_and) {
+  free(shift_and);
+}
+
+bool run_shift_and(const ShiftAnd* shift_and, const char* s, size_t len) {
+  const uint64_t state = feed_shift_and(shift_and, shift_and->start, s, len);
+  return state & shift_and->accept;
+}
+
+uint64_t feed_shift_and(const ShiftAnd* shift_and, uint64_t state,
+                        const char* s, size_t len) {
+  for (const char* end = s + len;
+       s != end && state && !(state & shift_and->found); s++) {
+    const uint64_t moved = state & shift_and->takes[(unsigned char)*s];
+    state = shift_and->restart;
+    for (int k = 0; k < shift_and->num_of_chunks; k++) {
+      state |= shift_and->follows[k][(moved >> (k * SHIFT_AND_CHUNK_BITS))
+                                     & ((1 << SHIFT_AND_CHUNK_BITS) - 1)];
+    }
+  }
+  return state;
+}
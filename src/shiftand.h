@@ -0,0 +1,68 @@
+#ifndef SHIFTAND_H
+#define SHIFTAND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "byteclass.h"
+#include "prog.h"
+
+enum {
+  /// @brief The number of positions that fit in the state word.
+  SHIFT_AND_MAX_POSITIONS = 64,
+  /// @brief The positions are followed 8 at a time through a table.
+  SHIFT_AND_CHUNK_BITS = 8,
+  SHIFT_AND_NUM_OF_CHUNKS = SHIFT_AND_MAX_POSITIONS / SHIFT_AND_CHUNK_BITS,
+};
+
+/// @brief A bit-parallel matcher of a program which has at most
+/// SHIFT_AND_MAX_POSITIONS important instructions, which are its positions in
+/// the sense of Glushkov. The whole state is a word with a bit per position,
+/// so a step is an AND with the positions that take the byte and a few table
+/// lookups to follow them.
+/// @details Unlike the Shift-And of a plain string, where each position is
+/// followed by the next one, the positions of a regexp may be followed by
+/// any others. The follows of the positions are thus precomputed for every
+/// value of each 8-bit chunk of the word, so following all the positions
+/// takes one lookup per chunk.
+typedef struct ShiftAnd {
+  /// @brief The positions of the initial instructions.
+  uint64_t start;
+  /// @brief The bit of the position of the accepting instruction.
+  uint64_t accept;
+  /// @brief The positions added back at every step, which are the start
+  /// positions in a search and none otherwise.
+  uint64_t restart;
+  /// @brief The accept bit in a search, which is stopped once it's set; 0
+  /// otherwise.
+  uint64_t found;
+  /// @brief The positions which take each byte.
+  uint64_t takes[NUM_OF_BYTES];
+  int num_of_chunks;
+  /// @brief follows[k][x] is the union of the follows of the positions 8k to
+  /// 8k + 7 with their bits set in x.
+  uint64_t follows[SHIFT_AND_NUM_OF_CHUNKS][1 << SHIFT_AND_CHUNK_BITS];
+} ShiftAnd;
+
+/// @return NULL if the program has more than SHIFT_AND_MAX_POSITIONS
+/// important instructions.
+/// @note Should be freed after use with delete_shift_and.
+ShiftAnd* create_shift_and(const Prog*);
+
+void delete_shift_and(ShiftAnd*);
+
+/// @return Whether the len bytes of s, which may have any value, null bytes
+/// included, are accepted.
+/// @note The matcher isn't modified, so it can be shared by threads.
+bool run_shift_and(const ShiftAnd*, const char* s, size_t len);
+
+/// @brief Steps the positions in state, starting from the start positions, on
+/// the len bytes of s, so a string can be fed in chunks.
+/// @return The positions after the bytes, which are 0 once no string that
+/// starts with the bytes fed is accepted. The bytes fed are accepted if the
+/// accept position is among them.
+uint64_t feed_shift_and(const ShiftAnd*, uint64_t state, const char* s,
+                        size_t len);
+
+#endif /* end of include guard: SHIFTAND_H */
@@ -0,0 +1,48 @@
+#include "sparseset.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @details The arrays are stored right after the set, in the same block.
+size_t get_sparse_set_size(int capacity) {
+  return sizeof(SparseSet) + sizeof(int) * 2 * capacity;
+}
+
+SparseSet* init_sparse_set(void* memory, int capacity) {
+  SparseSet* set = memory;
+  set->size = 0;
+  set->capacity = capacity;
+  set->dense = (int*)(set + 1);
+  set->sparse = set->dense + capacity;
+  // zeroed only to not read indeterminate values; any value would do
+  memset(set->sparse, 0, sizeof(int) * capacity);
+  return set;
+}
+
+SparseSet* create_sparse_set(int capacity) {
+  return init_sparse_set(malloc(get_sparse_set_size(capacity)), capacity);
+}
+
+void delete_sparse_set(SparseSet* set) {
+  free(set);
+}
+
+void insert_sparse_set(SparseSet* set, int i) {
+  if (contains_sparse_set(set, i)) {
+    return;
+  }
+  set->dense[set->size] = i;
+  set->sparse[i] = set->size;
+  set->size++;
+}
+
+bool contains_sparse_set(const SparseSet* set, int i) {
+  const unsigned pos = (unsigned)set->sparse[i];
+  return pos < (unsigned)set->size && set->dense[pos] == i;
+}
+
+void clear_sparse_set(SparseSet* set) {
+  set->size = 0;
+}
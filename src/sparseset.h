@@ -0,0 +1,43 @@
+#ifndef SPARSESET_H
+#define SPARSESET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// @brief A set of integers from 0 to capacity - 1 with constant time
+/// insertion, lookup and clearing, and iteration in the order of insertion.
+/// @details The members are stored in dense[0] to dense[size - 1], and
+/// sparse[i] is the position of i in dense if i is a member. sparse is never
+/// reset on clearing since a stale position is told by checking it against
+/// dense.
+/// See https://research.swtch.com/sparse.
+typedef struct SparseSet {
+  int size;
+  int capacity;
+  int* dense;
+  int* sparse;
+} SparseSet;
+
+/// @return An empty set which can hold the integers from 0 to capacity - 1.
+/// @note Should be freed after use with delete_sparse_set.
+SparseSet* create_sparse_set(int capacity);
+
+/// @return The number of bytes a set of the capacity takes.
+size_t get_sparse_set_size(int capacity);
+
+/// @brief Lays out an empty set in the memory, which has room for
+/// get_sparse_set_size(capacity) bytes and is aligned as malloc'd memory is.
+/// @note The memory is owned by the caller, so the set is never deleted.
+SparseSet* init_sparse_set(void* memory, int capacity);
+
+void delete_sparse_set(SparseSet*);
+
+/// @brief Inserts i into the set if it's not a member yet.
+void insert_sparse_set(SparseSet*, int i);
+
+bool contains_sparse_set(const SparseSet*, int i);
+
+/// @brief Removes all the members in constant time.
+void clear_sparse_set(SparseSet*);
+
+#endif /* end of include guard: SPARSESET_H */
@@ -2,57 +2,42 @@
 
 #include <stdlib.h>
 
-typedef struct StackNode {
-  void* val;
-  struct StackNode* next;
-} StackNode;
-
-static StackNode* create_stack_node(void* value, StackNode* next) {
-  StackNode* node = malloc(sizeof(StackNode));
-  node->val = value;
-  node->next = next;
-  return node;
-}
-
-static void delete_stack_node(StackNode* node) {
-  free(node);
-}
-
+/// @brief The values are kept in a growable array, so a push allocates only
+/// when the array is full, which happens O(log n) times.
 struct Stack {
-  StackNode* top;
+  void** values;
+  int size;
+  int capacity;
 };
 
 Stack* create_stack() {
   Stack* s = malloc(sizeof(Stack));
-  s->top = NULL;
+  s->size = 0;
+  s->capacity = 16;
+  s->values = malloc(sizeof(void*) * s->capacity);
   return s;
 }
 
 void push_stack(Stack* s, void* value) {
-  StackNode* new_node = create_stack_node(value, s->top);
-  s->top = new_node;
+  if (s->size == s->capacity) {
+    s->capacity *= 2;
+    s->values = realloc(s->values, sizeof(void*) * s->capacity);
+  }
+  s->values[s->size++] = value;
 }
 
 void* pop_stack(Stack* s) {
   if (is_empty_stack(s)) {
     return NULL;
   }
-  StackNode* top = s->top;
-  void* top_value = top->val;
-  s->top = s->top->next;
-  delete_stack_node(top);
-  return top_value;
+  return s->values[--s->size];
 }
 
 bool is_empty_stack(Stack* s) {
-  return s->top == NULL;
+  return s->size == 0;
 }
 
 void delete_stack(Stack* s) {
-  while (!is_empty_stack(s)) {
-    StackNode* top = s->top;
-    s->top = s->top->next;
-    delete_stack_node(top);
-  }
+  free(s->values);
   free(s);
 }
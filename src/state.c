@@ -1,8 +1,12 @@
 #include "state.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
 
+#include "arena.h"
+#include "byteset.h"
+
 size_t num_of_outs(int label) {
   if (label == SPLIT) {
     return 2;
@@ -24,24 +28,38 @@ size_t num_of_epsilon_outs(int label) {
 /// creation and then incremented.
 static int state_id = 0;
 
-State* create_state(const int label, State** outs) {
-  State* new_state = malloc(sizeof(State));
-  new_state->label = label;
-  new_state->id = state_id++;
-
-  new_state->outs = malloc(sizeof(State) * num_of_outs(label));
-  if (label == ACCEPT) {
-    new_state->outs[0] = NULL;
-  } else {
+static void init_state(State* s, int id, const int label, State** outs) {
+  s->label = label;
+  s->set = NULL;
+  s->id = id;
+  s->outs[0] = s->outs[1] = NULL;
+  if (label != ACCEPT) {
     for (size_t i = 0; i < num_of_outs(label); i++) {
-      new_state->outs[i] = outs[i];
+      s->outs[i] = outs[i];
     }
   }
+}
 
+State* create_state(const int label, State** outs) {
+  State* new_state = malloc(sizeof(State));
+  init_state(new_state, state_id++, label, outs);
   return new_state;
 }
 
+State* create_arena_state(Arena* arena, int id, const int label,
+                          State** outs) {
+  State* new_state = alloc_arena(arena, sizeof(State));
+  init_state(new_state, id, label, outs);
+  return new_state;
+}
+
+bool state_takes(const State* s, char c) {
+  if (s->label == CLASS) {
+    return contains_byte_set(s->set, c);
+  }
+  return s->label == (unsigned char)c || s->label == ANY;
+}
+
 void delete_state(State* s) {
-  free(s->outs);
   free(s);
 }
@@ -1,18 +1,31 @@
 #ifndef STATE_H
 #define STATE_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
+#include "arena.h"
+#include "byteset.h"
+
+/// @brief The labels other than the bytes, which are labels as unsigned char,
+/// so that none of the bytes is taken as one of them.
 enum {
-  EPSILON = 128,
-  SPLIT = 129,
-  ACCEPT = 130,
-  ANY = 131,  // any non-epsilon label
+  EPSILON = 256,
+  SPLIT = 257,
+  ACCEPT = 258,
+  ANY = 259,    // any non-epsilon label
+  CLASS = 260,  // any byte of a set
 };
 
 typedef struct State {
   int label;
-  struct State** outs;
+  /// @brief The bytes a CLASS state takes; NULL for the others.
+  /// @note Not owned by the state; allocated from the arena of the NFA.
+  const ByteSet* set;
+  /// @brief The states transited to, of which there are num_of_outs(label).
+  /// @note Kept inline, so a state takes a single allocation and can be
+  /// relabeled with any number of outs.
+  struct State* outs[2];
   /// @brief The unique id field is for NFAs to better handle their interior
   /// states.
   int id;
@@ -29,9 +42,21 @@ size_t num_of_epsilon_outs(int label);
 
 /// @note The accepting state may later become part of an NFA and turns into an
 /// epsilon state. outs is ignored under this condition since the space is only
-/// reserved.
+/// reserved. The id is taken from a counter shared by all states, so states
+/// should not be created this way by multiple threads at the same time.
 State* create_state(const int label, State** outs);
 
+/// @brief Creates the state in the same way as create_state does, but
+/// allocates it from the arena and gives it the id, which is kept unique
+/// within the NFA by the caller.
+/// @note The state is freed along with the arena, and should never be deleted
+/// with delete_state.
+State* create_arena_state(Arena*, int id, const int label, State** outs);
+
+/// @return Whether the state takes the byte, which none but the labeled ones
+/// do.
+bool state_takes(const State*, char c);
+
 /// @brief Deletes the state but not the states it transits to.
 void delete_state(State*);
 
@@ -0,0 +1,266 @@
+#include "utf8.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "byteset.h"
+#include "re2post.h"
+
+enum {
+  MIN_SURROGATE = 0xD800,
+  MAX_SURROGATE = 0xDFFF,
+};
+
+/// @brief The largest code point of each length of encoding.
+static const int max_code_point_of_len[MAX_UTF8_LEN + 1] = {-1, 0x7F, 0x7FF,
+                                                            0xFFFF, 0x10FFFF};
+
+/// @brief The bits the leading byte of each length of encoding starts with.
+static const unsigned char leading_bits_of_len[MAX_UTF8_LEN + 1] = {
+    0, 0x00, 0xC0, 0xE0, 0xF0};
+
+static bool is_surrogate(int code_point) {
+  return code_point >= MIN_SURROGATE && code_point <= MAX_SURROGATE;
+}
+
+static int get_utf8_len(int code_point) {
+  int len = 1;
+  while (code_point > max_code_point_of_len[len]) {
+    len++;
+  }
+  return len;
+}
+
+int decode_utf8(const char* s, int* code_point) {
+  const unsigned char* bytes = (const unsigned char*)s;
+  int len = 1;
+  if (bytes[0] >= 0x80) {
+    // the number of leading 1s of the leading byte
+    while (len <= MAX_UTF8_LEN && (bytes[0] & (0x80 >> len))) {
+      len++;
+    }
+    if (len == 1 || len > MAX_UTF8_LEN) {
+      return 0;  // a continuation byte or an invalid leading byte
+    }
+  }
+  int value = bytes[0] & (0x7F >> (len == 1 ? 0 : len));
+  for (int i = 1; i < len; i++) {
+    // which also stops at the null byte of a truncated character
+    if ((bytes[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+    value = value << 6 | (bytes[i] & 0x3F);
+  }
+  if (value <= max_code_point_of_len[len - 1] || value > MAX_CODE_POINT
+      || is_surrogate(value)) {
+    return 0;  // overlong, out of range, or a surrogate
+  }
+  *code_point = value;
+  return len;
+}
+
+int encode_utf8(int code_point, unsigned char* bytes) {
+  const int len = get_utf8_len(code_point);
+  for (int i = len - 1; i > 0; i--) {
+    bytes[i] = 0x80 | (code_point & 0x3F);
+    code_point >>= 6;
+  }
+  bytes[0] = leading_bits_of_len[len] | code_point;
+  return len;
+}
+
+CodePointSet* create_code_point_set() {
+  CodePointSet* set = malloc(sizeof(CodePointSet));
+  set->capacity = 4;
+  set->size = 0;
+  set->ranges = malloc(sizeof(CodePointRange) * set->capacity);
+  return set;
+}
+
+void delete_code_point_set(CodePointSet* set) {
+  free(set->ranges);
+  free(set);
+}
+
+void insert_code_point_range(CodePointSet* set, int low, int high) {
+  if (set->size == set->capacity) {
+    set->capacity *= 2;
+    set->ranges = realloc(set->ranges, sizeof(CodePointRange) * set->capacity);
+  }
+  set->ranges[set->size++] = (CodePointRange){.low = low, .high = high};
+}
+
+static int compare_ranges(const void* a, const void* b) {
+  return ((const CodePointRange*)a)->low - ((const CodePointRange*)b)->low;
+}
+
+void normalize_code_point_set(CodePointSet* set) {
+  qsort(set->ranges, set->size, sizeof(CodePointRange), compare_ranges);
+  int size = 0;
+  for (int i = 0; i < set->size; i++) {
+    if (size > 0 && set->ranges[i].low <= set->ranges[size - 1].high + 1) {
+      if (set->ranges[i].high > set->ranges[size - 1].high) {
+        set->ranges[size - 1].high = set->ranges[i].high;
+      }
+    } else {
+      set->ranges[size++] = set->ranges[i];
+    }
+  }
+  set->size = size;
+}
+
+/// @brief Replaces the code points of the normalized set with those not in it.
+static void complement_code_point_set(CodePointSet* set) {
+  CodePointRange* ranges = set->ranges;
+  const int size = set->size;
+  set->capacity = size + 1;
+  set->size = 0;
+  set->ranges = malloc(sizeof(CodePointRange) * set->capacity);
+  int low = 0;
+  for (int i = 0; i < size; i++) {
+    if (ranges[i].low > low) {
+      insert_code_point_range(set, low, ranges[i].low - 1);
+    }
+    low = ranges[i].high + 1;
+  }
+  if (low <= MAX_CODE_POINT) {
+    insert_code_point_range(set, low, MAX_CODE_POINT);
+  }
+  free(ranges);
+}
+
+const char* parse_code_point_set(const char* s, CodePointSet* set) {
+  set->size = 0;
+  s++;  // the opening [
+  const bool is_negated = *s == '^';
+  if (is_negated) {
+    s++;
+  }
+  // the first character is taken as is even if it's a ]
+  for (const char* first = s; *s != ']' || s == first;) {
+    int low;
+    int len;
+    if (!*s || !(len = decode_utf8(s, &low))) {
+      return NULL;
+    }
+    s += len;
+    int high = low;
+    if (s[0] == '-' && s[1] && s[1] != ']') {
+      if (!(len = decode_utf8(s + 1, &high)) || low > high) {
+        return NULL;
+      }
+      s += 1 + len;
+    }
+    insert_code_point_range(set, low, high);
+  }
+  normalize_code_point_set(set);
+  if (is_negated) {
+    complement_code_point_set(set);
+  }
+  return s + 1;
+}
+
+typedef struct {
+  char* chars;
+  size_t size;
+  size_t capacity;
+} Buffer;
+
+static void push_char(Buffer* buf, char c) {
+  if (buf->size == buf->capacity) {
+    buf->capacity *= 2;
+    buf->chars = realloc(buf->chars, buf->capacity);
+  }
+  buf->chars[buf->size++] = c;
+}
+
+/// @brief Writes the operand which takes a byte from low to high.
+static void write_byte_range(Buffer* buf, unsigned char low,
+                             unsigned char high) {
+  if (low == high && !is_operator_byte(low)) {
+    push_char(buf, (char)low);
+    return;
+  }
+  ByteSet set;
+  clear_byte_set(&set);
+  for (int b = low; b <= high; b++) {
+    insert_byte_set(&set, b);
+  }
+  char chars[BYTE_SET_MAX_STR_LEN + 1];
+  const size_t len = write_byte_set(&set, chars);
+  for (size_t i = 0; i < len; i++) {
+    push_char(buf, chars[i]);
+  }
+}
+
+/// @brief Writes the code points from low to high as an alternative of the
+/// union, which is split until it's a single sequence of byte ranges.
+/// @details The code points of a range which differ above the lowest i
+/// continuation bytes have to cover all of those bytes, except at the ends,
+/// which are split off.
+static void write_code_point_range(Buffer* buf, int low, int high,
+                                   bool is_first) {
+  for (int len = 1; len < MAX_UTF8_LEN; len++) {
+    const int max = max_code_point_of_len[len];
+    if (low <= max && max < high) {
+      write_code_point_range(buf, low, max, is_first);
+      write_code_point_range(buf, max + 1, high, false);
+      return;
+    }
+  }
+  for (int i = 1; i < MAX_UTF8_LEN; i++) {
+    const int mask = (1 << (6 * i)) - 1;
+    if ((low & ~mask) == (high & ~mask)) {
+      continue;
+    }
+    if ((low & mask) != 0) {
+      write_code_point_range(buf, low, low | mask, is_first);
+      write_code_point_range(buf, (low | mask) + 1, high, false);
+      return;
+    }
+    if ((high & mask) != mask) {
+      write_code_point_range(buf, low, (high & ~mask) - 1, is_first);
+      write_code_point_range(buf, high & ~mask, high, false);
+      return;
+    }
+  }
+  unsigned char low_bytes[MAX_UTF8_LEN];
+  unsigned char high_bytes[MAX_UTF8_LEN];
+  const int len = encode_utf8(low, low_bytes);
+  encode_utf8(high, high_bytes);
+  for (int i = 0; i < len; i++) {
+    write_byte_range(buf, low_bytes[i], high_bytes[i]);
+    if (i > 0) {
+      push_char(buf, EXPLICIT_CONCAT);
+    }
+  }
+  if (!is_first) {
+    push_char(buf, '|');
+  }
+}
+
+char* code_point_set2post(const CodePointSet* set) {
+  Buffer buf = {.chars = malloc(16), .size = 0, .capacity = 16};
+  bool is_first = true;
+  for (int i = 0; i < set->size; i++) {
+    const CodePointRange range = set->ranges[i];
+    if (range.low < MIN_SURROGATE) {
+      const int high =
+          range.high < MIN_SURROGATE ? range.high : MIN_SURROGATE - 1;
+      write_code_point_range(&buf, range.low, high, is_first);
+      is_first = false;
+    }
+    if (range.high > MAX_SURROGATE) {
+      const int low = range.low > MAX_SURROGATE ? range.low : MAX_SURROGATE + 1;
+      write_code_point_range(&buf, low, range.high, is_first);
+      is_first = false;
+    }
+  }
+  if (is_first) {
+    free(buf.chars);
+    return NULL;
+  }
+  push_char(&buf, '\0');
+  return buf.chars;
+}
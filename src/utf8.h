@@ -0,0 +1,65 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+enum {
+  MAX_CODE_POINT = 0x10FFFF,
+  MAX_UTF8_LEN = 4,
+};
+
+/// @brief Decodes the UTF-8 character which s starts with.
+/// @return The number of bytes of the character, from 1 to MAX_UTF8_LEN; 0 if
+/// s doesn't start with a well-formed one, e.g., with an overlong encoding or
+/// of a surrogate.
+int decode_utf8(const char* s, int* code_point);
+
+/// @brief Encodes the code point into UTF-8.
+/// @param bytes Room for MAX_UTF8_LEN bytes, which are not null-terminated.
+/// @return The number of bytes written.
+int encode_utf8(int code_point, unsigned char* bytes);
+
+typedef struct CodePointRange {
+  int low;
+  int high;
+} CodePointRange;
+
+/// @brief A set of code points, which is kept as ranges.
+typedef struct CodePointSet {
+  /// @brief Sorted, disjoint and non-adjacent once normalized.
+  CodePointRange* ranges;
+  int size;
+  int capacity;
+} CodePointSet;
+
+/// @note Should be freed after use with delete_code_point_set.
+CodePointSet* create_code_point_set(void);
+
+void delete_code_point_set(CodePointSet*);
+
+/// @brief Adds the code points from low to high into the set, which may break
+/// its normalization.
+void insert_code_point_range(CodePointSet*, int low, int high);
+
+/// @brief Sorts and merges the ranges of the set.
+void normalize_code_point_set(CodePointSet*);
+
+/// @brief Parses the bracket expression which s starts with into the set, in
+/// the same way as parse_byte_set does, but whose members are UTF-8
+/// characters rather than bytes. The complement of a negated one is taken
+/// over all the code points.
+/// @return The end of the bracket expression, which is right after its
+/// closing ]; NULL if it's ill-formed, which is also the case if it has a
+/// character that isn't well-formed UTF-8.
+/// @note The set is normalized.
+const char* parse_code_point_set(const char* s, CodePointSet*);
+
+/// @return The postfix form, in the notation of re2post, of the union of the
+/// UTF-8 byte sequences of the code points in the normalized set; NULL if it
+/// has none. Surrogates are never matched, as they have no UTF-8 encoding.
+/// @details Each range is split into ranges whose code points have the same
+/// length of encoding and, at each byte, a contiguous range of bytes, which
+/// are then written as the concatenation of those bytes. E.g., U+0080 to
+/// U+07FF is the sequence [\xc2-\xdf][\x80-\xbf].
+/// @note Should be freed after use with free.
+char* code_point_set2post(const CodePointSet*);
+
+#endif /* end of include guard: UTF8_H */
@@ -1,11 +1,25 @@
 #include <stdio.h>
 
+#include "byteset.h"
 #include "map.h"
 #include "nfa.h"
 #include "stack.h"
 
-/// @details The label of an epsilon transition is "eps", others are the
-/// characters they take.
+/// @brief Writes the bracket expression of the set, escaping the characters
+/// which would end the label early.
+static void set2dot(const ByteSet* set, FILE* f) {
+  char buf[BYTE_SET_MAX_STR_LEN + 1];
+  write_byte_set(set, buf);
+  for (const char* c = buf; *c; c++) {
+    if (*c == '"' || *c == '\\') {
+      fputc('\\', f);
+    }
+    fputc(*c, f);
+  }
+}
+
+/// @details The label of an epsilon transition is "eps", that of a class is
+/// its bracket expression, others are the characters they take.
 static void state2dot(State* state, FILE* f) {
   for (size_t i = 0; i < num_of_outs(state->label); i++) {
     fprintf(f, "\t%d -> %d", state->id, state->outs[i]->id);
@@ -14,6 +28,8 @@ static void state2dot(State* state, FILE* f) {
       fputs("eps", f);  // epsilon, avoid unicode
     } else if (state->label == ANY) {
       fputs("any", f);
+    } else if (state->label == CLASS) {
+      set2dot(state->set, f);
     } else {
       fputc(state->label, f);
     }
@@ -0,0 +1,46 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/arena.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief The allocations should be aligned and never overlap, even across
+/// chunks.
+static void test_alloc_arena() {
+  Arena* arena = create_arena();
+  char* ptrs[1000];
+
+  for (int i = 0; i < 1000; i++) {
+    ptrs[i] = alloc_arena(arena, i % 7 + 1);
+    assert_int_equal((uintptr_t)ptrs[i] % 16, 0);
+    memset(ptrs[i], i % 128, i % 7 + 1);
+  }
+  for (int i = 0; i < 1000; i++) {
+    for (int j = 0; j < i % 7 + 1; j++) {
+      assert_int_equal(ptrs[i][j], i % 128);
+    }
+  }
+
+  delete_arena(arena);
+}
+
+/// @brief An allocation larger than a chunk should get a chunk of its own.
+static void test_alloc_arena_larger_than_chunk() {
+  Arena* arena = create_arena();
+  const size_t size = ARENA_BASE_CAPACITY * 5;
+
+  char* ptr = alloc_arena(arena, size);
+  memset(ptr, 'a', size);
+
+  assert_true(get_arena_memory(arena) >= size + ARENA_BASE_CAPACITY);
+
+  delete_arena(arena);
+}
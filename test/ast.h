@@ -0,0 +1,105 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/ast.h"
+#include "../src/re2post.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief Asserts that re is simplified into post.
+static void assert_simplified(const char* re, const char* post) {
+  char* unsimplified = re2post(re);
+  char* simplified = simplify_post(unsimplified);
+  assert_string_equal(simplified, post);
+  free(simplified);
+  free(unsimplified);
+}
+
+static void test_simplify_nested_repetitions() {
+  assert_simplified("a**", "a*");
+  assert_simplified("(a*)*", "a*");
+  assert_simplified("(a+)?", "a*");
+  assert_simplified("(a+)+", "a+");
+  assert_simplified("(a?)?b", "a?b#");
+  assert_simplified("(a*b?)+", "a*b?#*");
+}
+
+static void test_simplify_bytes_into_class() {
+  assert_simplified("a|b|c", "[a-c]");
+  assert_simplified("(c|a)|b|a", "[a-c]");
+  assert_simplified("a|.|b", ".");
+  assert_simplified("(a|b)*", "[ab]*");
+  assert_simplified("[ab]|[bc]|d", "[a-d]");
+  assert_simplified("[^a]|a", ".");
+  assert_simplified("[a]", "a");
+  assert_simplified("[.]|[|]", "[.|]");
+  assert_simplified("[.]", "[.]");
+}
+
+static void test_simplify_common_prefixes_and_suffixes() {
+  assert_simplified("abc|abd", "ab#[cd]#");
+  assert_simplified("xa|ya", "[xy]a#");
+  assert_simplified("a|ab", "ab?#");
+  assert_simplified("ab|ab", "ab#");
+  assert_simplified("h1.c|h2.c|h3.c", "h[1-3]#.#c#");
+}
+
+/// @brief The trie grows past its initial nodes on the lone literal at the
+/// end, which is still kept.
+static void test_simplify_alternatives_growing_trie() {
+  assert_simplified("Za|Zb|Zc|Zd|Ze|Zf|Zg|Zh|Zi|Zj|Zk|Zl|Zm|Zn|.",
+                    ".Z[a-n]#|");
+}
+
+static void test_simplify_any_star_absorbs_nullable() {
+  assert_simplified(".*a*.*", ".*");
+  assert_simplified("a.*b?.*c", "a.*#c#");
+  assert_simplified("(a|b)*.*", ".*");
+}
+
+static void test_simplify_search_post_strips_any_stars() {
+  const char* res[] = {".*a.*", ".*a*b", "ab.*", ".*", ".*a|b.*"};
+  const char* posts[] = {"a", "b", "ab#", ".*", "b.*#.*a#|"};
+  for (int i = 0; i < 5; i++) {
+    char* unsimplified = re2post(res[i]);
+    char* simplified = simplify_search_post(unsimplified);
+    assert_string_equal(simplified, posts[i]);
+    free(simplified);
+    free(unsimplified);
+  }
+}
+
+/// @brief The literal is looked for in the concatenations and the pluses only.
+static void test_find_required_literal() {
+  const char* res[] = {".*ERROR: (a|b)+.*", "(ab)+c", "x(abc|abd)y",
+                       "a*b?", "(abc)?de", "[ab]c"};
+  const char* literals[] = {"ERROR: ", "ab", "x", "", "de", "c"};
+  for (int i = 0; i < 6; i++) {
+    char* post = re2post(res[i]);
+    char literal[8];
+    const size_t len = find_post_required_literal(post, literal, 8);
+    assert_int_equal(len, strlen(literals[i]));
+    assert_memory_equal(literal, literals[i], len);
+    free(post);
+  }
+  // a longer run is cut
+  char* post = re2post("abcdefghij");
+  char literal[4];
+  assert_int_equal(find_post_required_literal(post, literal, 4), 4);
+  assert_memory_equal(literal, "abcd", 4);
+  free(post);
+}
+
+static void test_simplify_post_ill_formed_should_return_null() {
+  assert_null(simplify_post("a#"));
+  assert_null(simplify_post("ab"));
+  assert_null(simplify_post("*"));
+}
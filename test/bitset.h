@@ -0,0 +1,78 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/bitset.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+static void test_bitset_insert_and_contains() {
+  Bitset* set = create_bitset(130);
+
+  insert_bitset(set, 0);
+  insert_bitset(set, 64);
+  insert_bitset(set, 129);
+
+  assert_int_equal(set->num_of_words, 3);
+  assert_true(contains_bitset(set, 0));
+  assert_true(contains_bitset(set, 64));
+  assert_true(contains_bitset(set, 129));
+  assert_false(contains_bitset(set, 1));
+  assert_false(contains_bitset(set, 63));
+
+  delete_bitset(set);
+}
+
+static void test_next_in_bitset() {
+  Bitset* set = create_bitset(300);
+  insert_bitset(set, 3);
+  insert_bitset(set, 200);
+
+  assert_int_equal(next_in_bitset(set, 0), 3);
+  assert_int_equal(next_in_bitset(set, 3), 3);
+  assert_int_equal(next_in_bitset(set, 4), 200);
+  assert_int_equal(next_in_bitset(set, 201), -1);
+  assert_int_equal(next_in_bitset(set, 300), -1);
+
+  delete_bitset(set);
+}
+
+/// @brief The sets are wide enough to take both the vector and the scalar
+/// loops.
+static void test_bitset_union_intersect_and_equal() {
+  Bitset* a = create_bitset(64 * 7);
+  Bitset* b = create_bitset(64 * 7);
+  Bitset* c = create_bitset(64 * 7);
+  for (int i = 0; i < 64 * 7; i += 3) {
+    insert_bitset(a, i);
+  }
+  for (int i = 0; i < 64 * 7; i += 5) {
+    insert_bitset(b, i);
+  }
+
+  intersect_bitset(c, a, b);
+  for (int i = 0; i < 64 * 7; i++) {
+    assert_int_equal(contains_bitset(c, i), i % 15 == 0);
+  }
+  union_bitset(c, a);
+  assert_true(bitset_equal(c, a));
+  assert_int_equal(hash_bitset(c), hash_bitset(a));
+  union_bitset(c, b);
+  assert_false(bitset_equal(c, a));
+  // differs only in the last word, which is compared by the scalar loop
+  Bitset* d = copy_bitset(c);
+  insert_bitset(d, 64 * 7 - 2);
+  assert_false(bitset_equal(c, d));
+  clear_bitset(d);
+  assert_true(is_empty_bitset(d));
+
+  delete_bitset(d);
+  delete_bitset(c);
+  delete_bitset(b);
+  delete_bitset(a);
+}
@@ -0,0 +1,63 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/bitvm.h"
+#include "../src/byteclass.h"
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+static void test_run_bit_vm() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+  Prog* prog = create_prog(nfa);
+  ByteClasses classes;
+  compute_byte_classes(prog, &classes);
+  BitVm* vm = create_bit_vm(prog, &classes);
+
+  assert_non_null(vm);
+  assert_true(run_bit_vm(vm, "abb", 3));
+  assert_false(run_bit_vm(vm, "abbc", 4));
+  assert_true(run_bit_vm(vm, "babb", 4));
+  assert_false(run_bit_vm(vm, "", 0));
+  assert_true(run_bit_vm(vm, "abaabbaabb", 10));
+  assert_false(run_bit_vm(vm, "abaabbab", 8));
+
+  delete_bit_vm(vm);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief The states span several words of the bitsets.
+static void test_run_bit_vm_many_states() {
+  char re[301] = {0};
+  char s[101] = {0};
+  for (int i = 0; i < 100; i++) {
+    re[i * 3] = 'a';
+    re[i * 3 + 1] = 'b';
+    re[i * 3 + 2] = '?';
+    s[i] = 'a';
+  }
+  Nfa* nfa = re2nfa(re);
+  Prog* prog = create_prog(nfa);
+  BitVm* vm = create_bit_vm(prog, NULL);
+
+  assert_non_null(vm);
+  assert_true(prog->num_of_insts > 128);
+  assert_true(run_bit_vm(vm, s, strlen(s)));
+  s[50] = 'b';
+  assert_false(run_bit_vm(vm, s, strlen(s)));
+  assert_false(run_bit_vm(vm, "ab", 2));
+
+  delete_bit_vm(vm);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
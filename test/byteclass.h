@@ -0,0 +1,78 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/byteclass.h"
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief a, b, and all the other bytes.
+static void test_compute_byte_classes() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+  Prog* prog = create_prog(nfa);
+  ByteClasses classes;
+
+  compute_byte_classes(prog, &classes);
+
+  assert_int_equal(classes.num_of_classes, 3);
+  assert_int_not_equal(classes.class_of['a'], classes.class_of['b']);
+  assert_int_equal(classes.class_of['c'], classes.class_of['z']);
+  assert_int_equal(classes.class_of['c'], classes.class_of[0xff]);
+  assert_int_not_equal(classes.class_of['a'], classes.class_of['c']);
+  for (int c = 0; c < classes.num_of_classes; c++) {
+    assert_int_equal(classes.class_of[classes.representatives[c]], c);
+  }
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief Any byte is taken by a dot, so there's nothing to tell apart.
+static void test_compute_byte_classes_any_should_not_split() {
+  Nfa* nfa = re2nfa(".*");
+  Prog* prog = create_prog(nfa);
+  ByteClasses classes;
+
+  compute_byte_classes(prog, &classes);
+
+  assert_int_equal(classes.num_of_classes, 1);
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief A class splits the bytes into those in it and the others.
+static void test_compute_byte_classes_with_class() {
+  Nfa* nfa = re2nfa("[a-c]x|b");
+  Prog* prog = create_prog(nfa);
+  ByteClasses classes;
+
+  compute_byte_classes(prog, &classes);
+
+  // {a, c}, {b}, {x}, and all the other bytes
+  assert_int_equal(classes.num_of_classes, 4);
+  assert_int_equal(classes.class_of['a'], classes.class_of['c']);
+  assert_int_not_equal(classes.class_of['a'], classes.class_of['b']);
+  assert_int_not_equal(classes.class_of['a'], classes.class_of['d']);
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+static void test_init_byte_classes() {
+  ByteClasses classes;
+
+  init_byte_classes(&classes);
+
+  assert_int_equal(classes.num_of_classes, NUM_OF_BYTES);
+  assert_int_equal(classes.class_of['a'], 'a');
+  assert_int_equal(classes.representatives[0xff], 0xff);
+}
@@ -0,0 +1,76 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/byteset.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+static void test_parse_byte_set() {
+  ByteSet set;
+
+  const char* s = "[a-cx]y";
+  assert_ptr_equal(parse_byte_set(s, &set), s + 6);
+  assert_int_equal(count_byte_set(&set), 4);
+  assert_true(contains_byte_set(&set, 'b'));
+  assert_true(contains_byte_set(&set, 'x'));
+  assert_false(contains_byte_set(&set, 'y'));
+
+  s = "[^0-9]";
+  assert_ptr_equal(parse_byte_set(s, &set), s + 6);
+  assert_int_equal(count_byte_set(&set), NUM_OF_BYTES - 10);
+  assert_false(contains_byte_set(&set, '5'));
+  assert_true(contains_byte_set(&set, 'a'));
+}
+
+/// @brief A ] is taken as is if it comes first, and so is a - at either end.
+static void test_parse_byte_set_special_bytes() {
+  ByteSet set;
+
+  assert_non_null(parse_byte_set("[]a]", &set));
+  assert_int_equal(count_byte_set(&set), 2);
+  assert_true(contains_byte_set(&set, ']'));
+
+  assert_non_null(parse_byte_set("[^]]", &set));
+  assert_int_equal(count_byte_set(&set), NUM_OF_BYTES - 1);
+  assert_false(contains_byte_set(&set, ']'));
+
+  assert_non_null(parse_byte_set("[-a-]", &set));
+  assert_int_equal(count_byte_set(&set), 2);
+  assert_true(contains_byte_set(&set, '-'));
+
+  assert_non_null(parse_byte_set("[a^]", &set));
+  assert_true(contains_byte_set(&set, '^'));
+}
+
+static void test_parse_byte_set_ill_formed_should_return_null() {
+  ByteSet set;
+
+  assert_null(parse_byte_set("[a", &set));
+  assert_null(parse_byte_set("[]", &set));
+  assert_null(parse_byte_set("[^", &set));
+  assert_null(parse_byte_set("[z-a]", &set));
+}
+
+/// @brief The bracket expression written is parsed back into the same set.
+static void test_write_byte_set() {
+  const char* sets[] = {"[a-c]", "[ab]", "[^a]", "[]^-]", "[-^]",
+                        "[.[|]", "[^^]", "[]a-z]"};
+  for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); i++) {
+    ByteSet set;
+    ByteSet parsed;
+    char buf[BYTE_SET_MAX_STR_LEN + 1];
+    parse_byte_set(sets[i], &set);
+
+    write_byte_set(&set, buf);
+
+    assert_string_equal(buf, sets[i]);
+    assert_non_null(parse_byte_set(buf, &parsed));
+    assert_true(byte_set_equal(&set, &parsed));
+  }
+}
@@ -0,0 +1,167 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/bitset.h"
+#include "../src/cache.h"
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+#include "../src/regexp.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief The same set of states inserted in different orders should be found
+/// as the same DFA state.
+static void test_find_dstate_should_ignore_insertion_order() {
+  Bitset* states = create_bitset(128);
+  insert_bitset(states, 5);
+  insert_bitset(states, 100);
+  insert_bitset(states, 3);
+  Bitset* same_states = create_bitset(128);
+  insert_bitset(same_states, 100);
+  insert_bitset(same_states, 3);
+  insert_bitset(same_states, 5);
+  DfaCache* cache = create_dfa_cache(NULL, NULL, 0);
+  DfaState* dstate = create_dfa_state(states, false);
+  cache_dstate(cache, dstate);
+
+  assert_ptr_equal(find_dstate(cache, same_states), dstate);
+  assert_ptr_equal(get_dstate(cache, dstate->id), dstate);
+
+  delete_bitset(same_states);
+  delete_dfa_cache(cache);
+}
+
+static void test_find_dstate_not_cached() {
+  Bitset* states = create_bitset(128);
+  insert_bitset(states, 1);
+  insert_bitset(states, 2);
+  Bitset* subset = create_bitset(128);
+  insert_bitset(subset, 1);
+  Bitset* superset = copy_bitset(states);
+  insert_bitset(superset, 3);
+  DfaCache* cache = create_dfa_cache(NULL, NULL, 0);
+  cache_dstate(cache, create_dfa_state(states, false));
+
+  assert_null(find_dstate(cache, subset));
+  assert_null(find_dstate(cache, superset));
+
+  delete_bitset(subset);
+  delete_bitset(superset);
+  delete_dfa_cache(cache);
+}
+
+/// @brief Moving to a set of states which is already built should reuse the
+/// cached DFA state instead of building a new one.
+static void test_get_next_dstate_should_reuse_cached_state() {
+  Nfa* nfa = re2nfa("ba*");
+  Prog* prog = create_prog(nfa);
+  DfaCache* cache = create_dfa_cache(prog, NULL, 0);
+  DfaState* start_dstate = get_start_dstate(cache);
+
+  DfaState* on_b = get_next_dstate(cache, start_dstate, 'b');
+  DfaState* on_ba = get_next_dstate(cache, on_b, 'a');
+
+  assert_ptr_not_equal(on_b, start_dstate);
+  assert_ptr_equal(on_b, on_ba);
+  assert_true(on_b->accepting);
+  assert_int_equal(cache->num_of_dstates, 2);
+
+  delete_dfa_cache(cache);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief The DFA states consist of the labeled and the accepting
+/// instructions only, so the epsilon ones in between shouldn't tell two DFA
+/// states apart.
+static void test_get_next_dstate_should_ignore_epsilon_states() {
+  Nfa* nfa = re2nfa("(a|a)b");
+  Prog* prog = create_prog(nfa);
+  DfaCache* cache = create_dfa_cache(prog, NULL, 0);
+  DfaState* start_dstate = get_start_dstate(cache);
+
+  DfaState* on_a = get_next_dstate(cache, start_dstate, 'a');
+
+  // the b reached from both of the alternatives, and nothing else
+  const int b = next_in_bitset(on_a->states, 0);
+  assert_int_equal(prog->insts[b].label, 'b');
+  assert_int_equal(next_in_bitset(on_a->states, b + 1), -1);
+
+  delete_dfa_cache(cache);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+static void test_flush_dfa_cache_should_keep_start_and_current() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+  Prog* prog = create_prog(nfa);
+  DfaCache* cache = create_dfa_cache(prog, NULL, 0);
+  DfaState* start_dstate = get_start_dstate(cache);
+  DfaState* on_a = get_next_dstate(cache, start_dstate, 'a');
+  DfaState* on_ab = get_next_dstate(cache, on_a, 'b');
+
+  flush_dfa_cache(cache, on_ab);
+
+  assert_int_equal(cache->num_of_dstates, 2);
+  assert_ptr_equal(get_dstate(cache, start_dstate->id), start_dstate);
+  assert_ptr_equal(get_dstate(cache, on_ab->id), on_ab);
+  assert_int_equal(cache->table[start_dstate->id * NUM_OF_BYTES + 'a'],
+                   NO_CACHE);
+  assert_int_equal(cache->num_of_flushes, 1);
+  assert_int_equal(cache->num_of_evictions, 1);
+
+  delete_dfa_cache(cache);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief A search collapses every set with the accepting state into the sink,
+/// which only moves to itself.
+static void test_get_next_dstate_unanchored_should_stop_at_sink() {
+  Nfa* nfa = re2nfa("ab");
+  Prog* prog = create_prog(nfa);
+  prog->unanchored = true;
+  DfaCache* cache = create_dfa_cache(prog, NULL, 0);
+  DfaState* start_dstate = get_start_dstate(cache);
+  DfaState* on_a = get_next_dstate(cache, start_dstate, 'a');
+  DfaState* on_ab = get_next_dstate(cache, on_a, 'b');
+
+  assert_ptr_equal(get_next_dstate(cache, start_dstate, 'x'), start_dstate);
+  assert_true(on_ab->accepting);
+  assert_int_equal(cache->sink_id, on_ab->id);
+  assert_ptr_equal(get_next_dstate(cache, on_ab, 'a'), on_ab);
+  assert_ptr_equal(feed_dfa_cache(cache, start_dstate, "xaabxx", 6), on_ab);
+  assert_int_equal(cache->num_of_dstates, 3);
+
+  delete_dfa_cache(cache);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief A cache with a budget too small for more DFA states is flushed over
+/// and over, which should not affect the results.
+static void test_match_regexp_with_cache_budget() {
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.cache = true;
+  options.cache_budget = 1;
+  Regexp* regexp = compile_regexp("(a|b)*abb", &options);
+
+  assert_true(match_regexp(regexp, "abaabbaabb"));
+  assert_false(match_regexp(regexp, "abaabbab"));
+  RegexpStats stats;
+  get_regexp_stats(regexp, &stats);
+  assert_true(stats.num_of_flushes > 0);
+  assert_true(stats.num_of_evictions > 0);
+  // the start state, the current state and the state just built
+  assert_true(stats.num_of_dstates <= 3);
+
+  delete_regexp(regexp);
+}
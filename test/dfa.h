@@ -0,0 +1,150 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/byteclass.h"
+#include "../src/dfa.h"
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+#include "../src/regexp.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+static void test_build_dfa() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+  Prog* prog = create_prog(nfa);
+
+  Dfa* dfa = build_dfa(prog, NULL, DFA_MAX_STATES);
+
+  assert_non_null(dfa);
+  assert_true(is_accepted_by_dfa(dfa, "abb", 3));
+  assert_true(is_accepted_by_dfa(dfa, "babb", 4));
+  assert_true(is_accepted_by_dfa(dfa, "abaabbaabb", 10));
+  assert_false(is_accepted_by_dfa(dfa, "abaabbbb", 8));
+  assert_false(is_accepted_by_dfa(dfa, "abaabbab", 8));
+  assert_false(is_accepted_by_dfa(dfa, "abbc", 4));
+
+  delete_dfa(dfa);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+static void test_build_dfa_too_many_states_should_return_null() {
+  // the DFA has to remember the last 4 characters, which takes 2^4 states
+  Nfa* nfa = re2nfa("(a|b)*a(a|b)(a|b)(a|b)");
+  Prog* prog = create_prog(nfa);
+
+  assert_null(build_dfa(prog, NULL, 8));
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief The minimal DFA of (a|b)*abb has 4 states, plus a dead state for the
+/// characters other than a and b.
+static void test_minimize_dfa() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+  Prog* prog = create_prog(nfa);
+  Dfa* dfa = build_dfa(prog, NULL, DFA_MAX_STATES);
+
+  Dfa* min_dfa = minimize_dfa(dfa);
+
+  assert_int_equal(min_dfa->num_of_states, 5);
+  assert_int_not_equal(min_dfa->dead, -1);
+  assert_true(is_accepted_by_dfa(min_dfa, "abb", 3));
+  assert_true(is_accepted_by_dfa(min_dfa, "babb", 4));
+  assert_true(is_accepted_by_dfa(min_dfa, "abaabbaabb", 10));
+  assert_false(is_accepted_by_dfa(min_dfa, "abaabbbb", 8));
+  assert_false(is_accepted_by_dfa(min_dfa, "abaabbab", 8));
+  assert_false(is_accepted_by_dfa(min_dfa, "abbc", 4));
+
+  delete_dfa(min_dfa);
+  delete_dfa(dfa);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief Equivalent alternatives should be merged into the same states.
+static void test_minimize_dfa_redundant_states() {
+  Nfa* nfa = re2nfa("(ab|ab|ab)*");
+  Prog* prog = create_prog(nfa);
+  Dfa* dfa = build_dfa(prog, NULL, DFA_MAX_STATES);
+
+  Dfa* min_dfa = minimize_dfa(dfa);
+
+  // the start (also accepting), the one after a, and the dead state
+  assert_int_equal(min_dfa->num_of_states, 3);
+  assert_true(is_accepted_by_dfa(min_dfa, "", 0));
+  assert_true(is_accepted_by_dfa(min_dfa, "abab", 4));
+  assert_false(is_accepted_by_dfa(min_dfa, "aba", 3));
+
+  delete_dfa(min_dfa);
+  delete_dfa(dfa);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+static void test_match_regexp_with_dfa() {
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.dfa = true;
+  Regexp* regexp = compile_regexp(".+a?", &options);
+
+  assert_true(match_regexp(regexp, "a"));
+  assert_true(match_regexp(regexp, "abc"));
+  assert_false(match_regexp(regexp, ""));
+  RegexpStats stats;
+  get_regexp_stats(regexp, &stats);
+  // the start state and the accepting state, which is never dead
+  assert_int_equal(stats.num_of_dfa_states, 2);
+  assert_int_equal(stats.num_of_dstates, 0);
+
+  delete_regexp(regexp);
+}
+
+static void test_match_regexp_with_dfa_should_fall_back_to_cache() {
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.dfa = true;
+  options.dfa_max_states = 8;
+  Regexp* regexp = compile_regexp("(a|b)*a(a|b)(a|b)(a|b)", &options);
+
+  assert_true(match_regexp(regexp, "abababaabb"));
+  assert_false(match_regexp(regexp, "abababbabb"));
+  RegexpStats stats;
+  get_regexp_stats(regexp, &stats);
+  assert_int_equal(stats.num_of_dfa_states, 0);
+  assert_true(stats.num_of_dstates > 0);
+
+  delete_regexp(regexp);
+}
+
+/// @brief The DFA over the byte classes should have the same states as the one
+/// over the bytes, with a column per class.
+static void test_minimize_dfa_with_byte_classes() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+  Prog* prog = create_prog(nfa);
+  ByteClasses classes;
+  compute_byte_classes(prog, &classes);
+  Dfa* dfa = build_dfa(prog, &classes, DFA_MAX_STATES);
+
+  Dfa* min_dfa = minimize_dfa(dfa);
+
+  assert_int_equal(min_dfa->classes.num_of_classes, 3);
+  assert_int_equal(min_dfa->num_of_states, 5);
+  assert_true(is_accepted_by_dfa(min_dfa, "abaabbaabb", 10));
+  assert_false(is_accepted_by_dfa(min_dfa, "abaabbab", 8));
+  assert_false(is_accepted_by_dfa(min_dfa, "abbc", 4));
+  assert_false(is_accepted_by_dfa(min_dfa, "\xff", 1));
+
+  delete_dfa(min_dfa);
+  delete_dfa(dfa);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
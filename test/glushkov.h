@@ -0,0 +1,129 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../src/glushkov.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+#include "../src/state.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief The ids of the follows from begin to end - 1 as bits.
+static int get_follow_bits(const Prog* prog, int begin, int end) {
+  const int* follow_ids = get_follow_ids(prog);
+  int bits = 0;
+  for (int i = begin; i < end; i++) {
+    bits |= 1 << follow_ids[i];
+  }
+  return bits;
+}
+
+/// @brief Each symbol has a position of its own, which follows the previous
+/// one without epsilon instructions in between.
+static void test_post2glushkov() {
+  Prog* prog = re2glushkov("a.b");
+
+  assert_non_null(prog);
+  assert_int_equal(prog->num_of_insts, 4);
+  assert_int_equal(prog->start, -1);
+  assert_int_equal(prog->accept, 3);
+  assert_int_equal(prog->insts[0].label, 'a');
+  assert_int_equal(prog->insts[1].label, ANY);
+  assert_int_equal(prog->insts[2].label, 'b');
+  assert_int_equal(prog->insts[3].label, ACCEPT);
+  assert_int_equal(
+      get_follow_bits(prog, prog->initial_begin, prog->initial_end), 0x1);
+  for (int i = 0; i < 3; i++) {
+    const Inst* inst = &prog->insts[i];
+    assert_int_equal(
+        get_follow_bits(prog, inst->follow_begin, inst->follow_end),
+        1 << (i + 1));
+  }
+
+  delete_prog(prog);
+}
+
+/// @brief The bytes of the bracket expressions are stored in the program, and
+/// are indexed by their positions.
+static void test_post2glushkov_class() {
+  Prog* prog = re2glushkov("[a-c]x[^x]");
+
+  assert_non_null(prog);
+  assert_int_equal(prog->num_of_sets, 2);
+  assert_int_equal(prog->insts[0].label, CLASS);
+  assert_int_equal(prog->insts[1].label, 'x');
+  assert_int_equal(prog->insts[1].set, -1);
+  assert_int_equal(prog->insts[2].label, CLASS);
+  assert_true(inst_takes(prog, &prog->insts[0], 'b'));
+  assert_false(inst_takes(prog, &prog->insts[0], 'x'));
+  assert_true(inst_takes(prog, &prog->insts[2], 'b'));
+  assert_false(inst_takes(prog, &prog->insts[2], 'x'));
+
+  delete_prog(prog);
+}
+
+/// @brief Each optional copy of a counted repetition only follows the previous
+/// one, so the follows take space linear in the bound.
+static void test_post2glushkov_counted_repetition() {
+  Prog* prog = re2glushkov("a{1,1000}");
+
+  assert_non_null(prog);
+  assert_int_equal(prog->num_of_insts, 1001);
+  assert_true(prog->num_of_follow_ids < 3 * 1000);
+
+  delete_prog(prog);
+}
+
+/// @brief The position of a may start the match, follow itself and end the
+/// match, which is added once even though both of the stars add it.
+static void test_post2glushkov_nested_stars() {
+  Prog* prog = re2glushkov("(a*)*b?");
+
+  assert_non_null(prog);
+  assert_int_equal(prog->num_of_insts, 3);
+  const Inst* a = &prog->insts[0];
+  assert_int_equal(a->follow_end - a->follow_begin, 3);
+  assert_int_equal(get_follow_bits(prog, a->follow_begin, a->follow_end),
+                   0x7);
+  assert_int_equal(
+      get_follow_bits(prog, prog->initial_begin, prog->initial_end), 0x7);
+
+  delete_prog(prog);
+}
+
+static void test_post2glushkov_ill_formed_should_return_null() {
+  assert_null(post2glushkov("ab"));
+  assert_null(post2glushkov("a|"));
+  assert_null(post2glushkov("*"));
+  assert_null(post2glushkov(""));
+}
+
+/// @brief Each alternative of a starred union follows every one, so the
+/// follows are quadratic in the number of alternatives and are capped.
+static void test_post2glushkov_too_many_follows_should_return_null() {
+  const int num_of_alts = 1100;  // squared is above PROG_MAX_FOLLOW_IDS
+  // "a|" for each alternative, the union of which is starred
+  char* post = malloc(num_of_alts * 2 + 1);
+  post[0] = 'a';
+  for (int i = 1; i < num_of_alts; i++) {
+    post[i * 2 - 1] = 'a';
+    post[i * 2] = '|';
+  }
+  post[num_of_alts * 2 - 1] = '*';
+  post[num_of_alts * 2] = '\0';
+
+  assert_null(post2glushkov(post));
+  post[num_of_alts * 2 - 1] = '\0';  // without the star
+  Prog* prog = post2glushkov(post);
+  assert_non_null(prog);
+
+  delete_prog(prog);
+  free(post);
+}
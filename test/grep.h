@@ -0,0 +1,136 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/grep.h"
+#include "../src/regexp.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief The newline is found wherever it is relative to the vectors.
+static void test_find_newline() {
+  char buf[100];
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    memset(buf, 'a', sizeof(buf));
+    buf[i] = '\n';
+
+    assert_ptr_equal(find_newline(buf, buf + sizeof(buf)), buf + i);
+    assert_ptr_equal(find_newline(buf, buf + i), buf + i);
+  }
+  memset(buf, 'a', sizeof(buf));
+  assert_ptr_equal(find_newline(buf, buf + sizeof(buf)), buf + sizeof(buf));
+}
+
+typedef struct {
+  const char* lines[4];
+  int num_of_lines;
+  int max_lines;
+} CollectedLines;
+
+static bool collect_line(const char* line, size_t len, void* data) {
+  CollectedLines* collected = data;
+  collected->lines[collected->num_of_lines++] = line;
+  (void)len;
+  return collected->num_of_lines < collected->max_lines;
+}
+
+/// @brief A last line without a newline is a line, but a newline at the end
+/// doesn't start an empty one.
+static void test_grep_lines() {
+  Regexp* regexp = compile_regexp("(a|b)*abb", NULL);
+  const char buf[] = "abb\nab\n\nbabb\nxabb\nabb";
+  const size_t len = sizeof(buf) - 1;
+
+  assert_int_equal(grep_lines(regexp, buf, len, NULL, NULL), 3);
+  assert_int_equal(grep_lines(regexp, buf, len - 3, NULL, NULL), 2);
+  CollectedLines collected = {.num_of_lines = 0, .max_lines = 4};
+  grep_lines(regexp, buf, len, collect_line, &collected);
+  assert_int_equal(collected.num_of_lines, 3);
+  assert_ptr_equal(collected.lines[1], buf + 8);
+  assert_ptr_equal(collected.lines[2], buf + len - 3);
+
+  Regexp* empty = compile_regexp("a*", NULL);
+  assert_int_equal(grep_lines(empty, buf, len, NULL, NULL), 1);
+  assert_int_equal(grep_lines(empty, "\n\n", 2, NULL, NULL), 2);
+
+  delete_regexp(empty);
+  delete_regexp(regexp);
+}
+
+static void test_grep_lines_should_stop_once_told() {
+  Regexp* regexp = compile_regexp("a+", NULL);
+  const char buf[] = "a\naa\naaa\n";
+  CollectedLines collected = {.num_of_lines = 0, .max_lines = 1};
+
+  assert_int_equal(grep_lines(regexp, buf, sizeof(buf) - 1, collect_line,
+                              &collected),
+                   1);
+  assert_ptr_equal(collected.lines[0], buf);
+
+  delete_regexp(regexp);
+}
+
+typedef struct {
+  const char* last_line;
+  size_t num_of_lines;
+  size_t max_lines;
+  bool is_in_order;
+} OrderedLines;
+
+static bool check_line_order(const char* line, size_t len, void* data) {
+  OrderedLines* ordered = data;
+  ordered->is_in_order &= line > ordered->last_line && len == 3;
+  ordered->last_line = line;
+  return ++ordered->num_of_lines < ordered->max_lines;
+}
+
+/// @brief The lines span many chunks, whose lines matched are still passed in
+/// order.
+static void test_grep_lines_in_parallel() {
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.cache = true;
+  Regexp* regexp = compile_regexp("(a|b)*abb", &options);
+  // "abb\n" and "ab\n" alternate over several megabytes
+  const size_t num_of_pairs = 1 << 20;
+  char* buf = malloc(num_of_pairs * 7);
+  for (size_t i = 0; i < num_of_pairs; i++) {
+    memcpy(buf + i * 7, "abb\nab\n", 7);
+  }
+  const size_t len = num_of_pairs * 7;
+
+  for (int num_of_threads = 1; num_of_threads <= 4; num_of_threads++) {
+    assert_int_equal(
+        grep_lines_in_parallel(regexp, buf, len, num_of_threads, NULL, NULL),
+        num_of_pairs);
+    OrderedLines ordered
+        = {.last_line = NULL, .max_lines = SIZE_MAX, .is_in_order = true};
+    assert_int_equal(grep_lines_in_parallel(regexp, buf, len, num_of_threads,
+                                            check_line_order, &ordered),
+                     num_of_pairs);
+    assert_true(ordered.is_in_order);
+    assert_int_equal(ordered.num_of_lines, num_of_pairs);
+
+    ordered = (OrderedLines){
+        .last_line = NULL, .max_lines = 300000, .is_in_order = true};
+    assert_int_equal(grep_lines_in_parallel(regexp, buf, len, num_of_threads,
+                                            check_line_order, &ordered),
+                     300000);
+    assert_ptr_equal(ordered.last_line, buf + 299999 * 7);
+  }
+  // the last line has no newline
+  assert_int_equal(grep_lines_in_parallel(regexp, buf, len - 4, 2, NULL, NULL),
+                   num_of_pairs);
+  assert_int_equal(grep_lines_in_parallel(regexp, buf, 0, 2, NULL, NULL), 0);
+
+  free(buf);
+  delete_regexp(regexp);
+}
@@ -0,0 +1,36 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/literal.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief The literal is found wherever it is relative to the vectors, and
+/// partial occurrences aren't taken for it.
+static void test_find_literal() {
+  char buf[100];
+  for (size_t i = 0; i + 5 <= sizeof(buf); i++) {
+    // ERRxR agrees with ERROR on the first and the last bytes
+    memset(buf, 'R', sizeof(buf));
+    memcpy(buf, "ERRxR", 5);
+    memcpy(buf + i, "ERROR", 5);
+
+    assert_ptr_equal(find_literal(buf, buf + sizeof(buf), "ERROR", 5),
+                     buf + i);
+    assert_ptr_equal(find_literal(buf, buf + i + 4, "ERROR", 5), buf + i + 4);
+  }
+  memset(buf, 'R', sizeof(buf));
+  assert_ptr_equal(find_literal(buf, buf + sizeof(buf), "ERROR", 5),
+                   buf + sizeof(buf));
+  buf[sizeof(buf) - 1] = 'E';
+  assert_ptr_equal(find_literal(buf, buf + sizeof(buf), "E", 1),
+                   buf + sizeof(buf) - 1);
+  assert_ptr_equal(find_literal(buf, buf + sizeof(buf), "", 0), buf);
+}
@@ -3,12 +3,28 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "arena.h"
+#include "ast.h"
+#include "bitset.h"
+#include "bitvm.h"
+#include "byteclass.h"
+#include "byteset.h"
+#include "cache.h"
+#include "dfa.h"
+#include "glushkov.h"
+#include "grep.h"
+#include "literal.h"
 #include "map.h"
 #include "nfa.h"
+#include "pikevm.h"
 #include "post2nfa.h"
+#include "prog.h"
 #include "re2post.h"
 #include "regexp.h"
+#include "shiftand.h"
+#include "sparseset.h"
 #include "state.h"
+#include "utf8.h"
 
 // clang-format off
 // cmocka allows test applications to use custom definitions of C standard
@@ -18,6 +34,18 @@
 
 int main(void) {
   const struct CMUnitTest tests[] = {
+      // arena.h
+      cmocka_unit_test(test_alloc_arena),
+      cmocka_unit_test(test_alloc_arena_larger_than_chunk),
+      // ast.h
+      cmocka_unit_test(test_simplify_nested_repetitions),
+      cmocka_unit_test(test_simplify_bytes_into_class),
+      cmocka_unit_test(test_simplify_common_prefixes_and_suffixes),
+      cmocka_unit_test(test_simplify_alternatives_growing_trie),
+      cmocka_unit_test(test_simplify_any_star_absorbs_nullable),
+      cmocka_unit_test(test_simplify_post_ill_formed_should_return_null),
+      cmocka_unit_test(test_simplify_search_post_strips_any_stars),
+      cmocka_unit_test(test_find_required_literal),
       // re2post.h
       cmocka_unit_test(test_re2post_single_character),
       cmocka_unit_test(test_re2post_concat),
@@ -31,6 +59,17 @@ int main(void) {
       cmocka_unit_test(test_re2post_concat_with_paren),
       cmocka_unit_test(test_re2post_union_with_paren),
       cmocka_unit_test(test_re2post_mix),
+      cmocka_unit_test(test_re2post_long_re),
+      cmocka_unit_test(test_re2post_bracket),
+      cmocka_unit_test(test_re2post_ill_formed_bracket_should_return_null),
+      cmocka_unit_test(test_re2post_counted_repetition),
+      cmocka_unit_test(test_re2post_repetition_of_zero_times),
+      cmocka_unit_test(test_re2post_brace_should_be_literal),
+      cmocka_unit_test(
+          test_re2post_ill_formed_counted_repetition_should_return_null),
+      cmocka_unit_test(test_re2post_too_large_repetition_should_return_null),
+      cmocka_unit_test(test_re2post_utf8),
+      cmocka_unit_test(test_re2post_utf8_ill_formed_should_return_null),
       cmocka_unit_test(test_re2post_empty_re_should_be_empty_post),
       cmocka_unit_test(test_re2post_missing_operand_should_return_null),
       cmocka_unit_test(test_re2post_mismatch_paren_should_return_null),
@@ -41,11 +80,13 @@ int main(void) {
       cmocka_unit_test(test_create_any_state),
       // nfa.h
       cmocka_unit_test(test_create_nfa),
+      cmocka_unit_test(test_delete_nfa_long_chain),
       // post2nfa.h
       cmocka_unit_test(test_post2nfa_single_character),
       cmocka_unit_test(test_post2nfa_concat_only),
       cmocka_unit_test(test_post2nfa_union_only_single),
       cmocka_unit_test(test_post2nfa_union_only_complex),
+      cmocka_unit_test(test_post2nfa_class),
       cmocka_unit_test(test_post2nfa_zero_or_more),
       cmocka_unit_test(test_post2nfa_zero_or_one),
       cmocka_unit_test(test_post2nfa_one_or_more),
@@ -57,6 +98,35 @@ int main(void) {
       cmocka_unit_test(test_post2nfa_missing_operator_should_return_null),
       cmocka_unit_test(test_post2nfa_missing_operand_should_return_null),
       cmocka_unit_test(test_post2nfa_empty_post_should_return_null),
+      // prog.h
+      cmocka_unit_test(test_create_prog),
+      cmocka_unit_test(test_create_prog_should_have_dense_ids),
+      cmocka_unit_test(test_copy_prog),
+      cmocka_unit_test(test_create_prog_should_precompute_follows),
+      // sparseset.h
+      cmocka_unit_test(test_sparse_set_insert_and_contains),
+      cmocka_unit_test(test_sparse_set_clear),
+      cmocka_unit_test(test_init_sparse_set),
+      // pikevm.h
+      cmocka_unit_test(test_run_pike_vm),
+      cmocka_unit_test(test_run_pike_vm_nested_stars),
+      cmocka_unit_test(test_run_pike_vm_unanchored),
+      // bitset.h
+      cmocka_unit_test(test_bitset_insert_and_contains),
+      cmocka_unit_test(test_next_in_bitset),
+      cmocka_unit_test(test_bitset_union_intersect_and_equal),
+      // bitvm.h
+      cmocka_unit_test(test_run_bit_vm),
+      cmocka_unit_test(test_run_bit_vm_many_states),
+      // shiftand.h
+      cmocka_unit_test(test_create_shift_and_too_many_positions),
+      // glushkov.h
+      cmocka_unit_test(test_post2glushkov),
+      cmocka_unit_test(test_post2glushkov_class),
+      cmocka_unit_test(test_post2glushkov_counted_repetition),
+      cmocka_unit_test(test_post2glushkov_nested_stars),
+      cmocka_unit_test(test_post2glushkov_ill_formed_should_return_null),
+      cmocka_unit_test(test_post2glushkov_too_many_follows_should_return_null),
       // regexp.h
       cmocka_unit_test(test_epsilon_closure_on_epsilon),
       cmocka_unit_test(test_epsilon_closure_on_split),
@@ -66,15 +136,80 @@ int main(void) {
       cmocka_unit_test(test_move_null),
       cmocka_unit_test(test_is_accepted),
       cmocka_unit_test(test_is_accepted_with_cache),
+      cmocka_unit_test(test_is_accepted_with_shift_and),
       cmocka_unit_test(test_regexp_paren_and_zero_or_more),
       cmocka_unit_test(test_regexp_paren_and_zero_or_more_with_cache),
+      cmocka_unit_test(test_regexp_paren_and_zero_or_more_with_shift_and),
       cmocka_unit_test(test_regexp_any_and_one_or_more),
       cmocka_unit_test(test_regexp_any_and_one_or_more_with_cache),
+      cmocka_unit_test(test_regexp_any_and_one_or_more_with_shift_and),
+      cmocka_unit_test(test_regexp_zero_or_one_with_shift_and),
+      cmocka_unit_test(test_compile_regexp_ill_formed_should_return_null),
+      cmocka_unit_test(test_match_regexp_many_strings),
+      cmocka_unit_test(test_match_regexp_many_strings_with_cache),
+      cmocka_unit_test(test_match_regexp_with_glushkov),
+      cmocka_unit_test(test_match_regexp_with_class),
+      cmocka_unit_test(test_match_regexp_with_counted_repetition),
+      cmocka_unit_test(test_match_regexp_utf8),
+      cmocka_unit_test(test_match_regexp_high_bytes),
+      cmocka_unit_test(test_match_regexp_n),
+      cmocka_unit_test(test_regexp_stream),
+      cmocka_unit_test(test_compile_regexp_long_alternation),
+      cmocka_unit_test(test_compile_regexp_glushkov_falls_back),
+      cmocka_unit_test(test_match_regexp_with_scratch),
+      cmocka_unit_test(test_match_regexp_with_matcher),
+      cmocka_unit_test(test_search_regexp),
+      cmocka_unit_test(test_search_regexp_with_literal),
+      // literal.h
+      cmocka_unit_test(test_find_literal),
       // map.h
       cmocka_unit_test(test_map_insert_and_search),
       cmocka_unit_test(test_map_delete),
       cmocka_unit_test(test_map_capacity_should_grow),
       cmocka_unit_test(test_map_iterator),
+      cmocka_unit_test(test_map_delete_should_keep_probe_chains),
+      cmocka_unit_test(test_map_churn_should_not_grow),
+      cmocka_unit_test(test_map_reserve),
+      cmocka_unit_test(test_map_for_each),
+      // cache.h
+      cmocka_unit_test(test_find_dstate_should_ignore_insertion_order),
+      cmocka_unit_test(test_find_dstate_not_cached),
+      cmocka_unit_test(test_get_next_dstate_should_reuse_cached_state),
+      cmocka_unit_test(test_get_next_dstate_should_ignore_epsilon_states),
+      cmocka_unit_test(test_flush_dfa_cache_should_keep_start_and_current),
+      cmocka_unit_test(test_get_next_dstate_unanchored_should_stop_at_sink),
+      cmocka_unit_test(test_match_regexp_with_cache_budget),
+      // dfa.h
+      cmocka_unit_test(test_build_dfa),
+      cmocka_unit_test(test_build_dfa_too_many_states_should_return_null),
+      cmocka_unit_test(test_minimize_dfa),
+      cmocka_unit_test(test_minimize_dfa_redundant_states),
+      cmocka_unit_test(test_match_regexp_with_dfa),
+      cmocka_unit_test(test_match_regexp_with_dfa_should_fall_back_to_cache),
+      cmocka_unit_test(test_minimize_dfa_with_byte_classes),
+      // byteclass.h
+      cmocka_unit_test(test_init_byte_classes),
+      cmocka_unit_test(test_compute_byte_classes),
+      cmocka_unit_test(test_compute_byte_classes_any_should_not_split),
+      cmocka_unit_test(test_compute_byte_classes_with_class),
+      // byteset.h
+      cmocka_unit_test(test_parse_byte_set),
+      cmocka_unit_test(test_parse_byte_set_special_bytes),
+      cmocka_unit_test(test_parse_byte_set_ill_formed_should_return_null),
+      cmocka_unit_test(test_write_byte_set),
+      // grep.h
+      cmocka_unit_test(test_find_newline),
+      cmocka_unit_test(test_grep_lines),
+      cmocka_unit_test(test_grep_lines_should_stop_once_told),
+      cmocka_unit_test(test_grep_lines_in_parallel),
+      // utf8.h
+      cmocka_unit_test(test_decode_utf8),
+      cmocka_unit_test(test_decode_utf8_ill_formed_should_return_0),
+      cmocka_unit_test(test_encode_utf8),
+      cmocka_unit_test(test_parse_code_point_set),
+      cmocka_unit_test(test_code_point_set2post),
+      cmocka_unit_test(
+          test_code_point_set2post_of_surrogates_should_return_null),
   };
 
   return cmocka_run_group_tests(tests, NULL, NULL);
@@ -105,3 +105,90 @@ static void test_map_iterator() {
   delete_map_iterator(itr);
   delete_map(map);
 }
+
+/// @brief Deleted keys are left as tombstones, so the keys probed past them
+/// should still be found, and the slots can be reused.
+static void test_map_delete_should_keep_probe_chains() {
+  Map* map = create_map();
+  int vals[200];
+  for (int i = 0; i < 200; i++) {
+    insert_pair(map, i * MAP_BASE_CAPACITY, vals + i);
+  }
+
+  for (int i = 0; i < 200; i += 2) {
+    delete_pair(map, i * MAP_BASE_CAPACITY);
+  }
+
+  assert_int_equal(get_size(map), 100);
+  for (int i = 0; i < 200; i++) {
+    if (i % 2) {
+      assert_ptr_equal(get_value(map, i * MAP_BASE_CAPACITY), vals + i);
+    } else {
+      assert_null(get_value(map, i * MAP_BASE_CAPACITY));
+    }
+  }
+  insert_pair(map, 0, vals);
+  assert_ptr_equal(get_value(map, 0), vals);
+  assert_int_equal(get_size(map), 101);
+
+  delete_map(map);
+}
+
+/// @brief Inserting and deleting keys over and over should clean up the
+/// tombstones instead of growing the map.
+static void test_map_churn_should_not_grow() {
+  Map* map = create_map();
+  int val;
+  const size_t memory = get_memory_usage(map);
+
+  for (int i = 0; i < 100000; i++) {
+    insert_pair(map, i, &val);
+    delete_pair(map, i);
+  }
+
+  assert_int_equal(get_size(map), 0);
+  assert_int_equal(get_memory_usage(map), memory);
+
+  delete_map(map);
+}
+
+/// @brief A map with reserved capacity should not grow until it's filled up.
+static void test_map_reserve() {
+  Map* map = create_map_with_capacity(1000);
+  int val;
+  const size_t memory = get_memory_usage(map);
+
+  for (int i = 0; i < 1000; i++) {
+    insert_pair(map, i, &val);
+  }
+  assert_int_equal(get_memory_usage(map), memory);
+  reserve_map(map, 10);
+  assert_int_equal(get_memory_usage(map), memory);
+  reserve_map(map, 10000);
+  assert_true(get_memory_usage(map) > memory);
+  for (int i = 0; i < 1000; i++) {
+    assert_ptr_equal(get_value(map, i), &val);
+  }
+
+  delete_map(map);
+}
+
+/// @brief The iteration macro should visit each pair once without allocating
+/// the iterator.
+static void test_map_for_each() {
+  Map* map = create_map();
+  int vals[10];
+  for (int i = 0; i < 10; i++) {
+    insert_pair(map, i, vals + i);
+  }
+
+  int sum = 0;
+  FOR_EACH_ITR(map, itr, {
+    assert_ptr_equal(get_current_value(itr), vals + get_current_key(itr));
+    sum += get_current_key(itr);
+  });
+
+  assert_int_equal(sum, 45);
+
+  delete_map(map);
+}
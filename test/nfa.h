@@ -22,3 +22,17 @@ static void test_create_nfa() {
 
   delete_nfa(nfa);
 }
+
+/// @brief A long chain of states should be deleted without recursing on each
+/// of them.
+static void test_delete_nfa_long_chain() {
+  State* accept = create_state(ACCEPT, NULL);
+  State* start = accept;
+  for (int i = 0; i < 1000000; i++) {
+    start = create_state(EPSILON, &start);
+  }
+
+  Nfa* nfa = create_nfa(start, accept);
+
+  delete_nfa(nfa);
+}
@@ -0,0 +1,71 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/pikevm.h"
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief The lists are reused across runs, so a run shouldn't be affected by
+/// the states left from the previous one.
+static void test_run_pike_vm() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+  Prog* prog = create_prog(nfa);
+  PikeVm* vm = create_pike_vm(prog);
+
+  assert_true(run_pike_vm(vm, "abb", 3));
+  assert_false(run_pike_vm(vm, "abbc", 4));
+  assert_true(run_pike_vm(vm, "babb", 4));
+  assert_false(run_pike_vm(vm, "", 0));
+  assert_true(run_pike_vm(vm, "abaabbaabb", 10));
+  assert_false(run_pike_vm(vm, "abaabbab", 8));
+
+  delete_pike_vm(vm);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief Nested stars have epsilon cycles, which shouldn't be followed more
+/// than once.
+static void test_run_pike_vm_nested_stars() {
+  Nfa* nfa = re2nfa("((a*)*b?)*");
+  Prog* prog = create_prog(nfa);
+  PikeVm* vm = create_pike_vm(prog);
+
+  assert_true(run_pike_vm(vm, "", 0));
+  assert_true(run_pike_vm(vm, "aabab", 5));
+  assert_false(run_pike_vm(vm, "aac", 3));
+
+  delete_pike_vm(vm);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief A search starts over at every byte and stops at the first match.
+static void test_run_pike_vm_unanchored() {
+  Nfa* nfa = re2nfa("ab+a");
+  Prog* prog = create_prog(nfa);
+  prog->unanchored = true;
+  PikeVm* vm = create_pike_vm(prog);
+
+  assert_true(run_pike_vm(vm, "xxabbbaxx", 9));
+  assert_true(run_pike_vm(vm, "aba", 3));
+  assert_false(run_pike_vm(vm, "abbxa", 5));
+  assert_false(run_pike_vm(vm, "", 0));
+  start_pike_vm(vm);
+  feed_pike_vm(vm, "aaba", 4);
+  feed_pike_vm(vm, "xx", 2);
+  assert_true(is_pike_vm_accepting(vm));
+
+  delete_pike_vm(vm);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
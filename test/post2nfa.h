@@ -94,6 +94,19 @@ static void test_post2nfa_any_concat() {
   delete_nfa(nfa);
 }
 
+/// @brief A bracket expression is a single state labeled by its bytes.
+static void test_post2nfa_class() {
+  Nfa* nfa = post2nfa("[a-c]d#");
+
+  assert_non_null(nfa);
+  ASSERT_NON_SPLIT_TRANSITION_LABELS(nfa->start, CLASS, 'd', ACCEPT);
+  assert_int_equal(count_byte_set(nfa->start->set), 3);
+  assert_true(contains_byte_set(nfa->start->set, 'b'));
+  assert_null(nfa->start->outs[0]->set);
+
+  delete_nfa(nfa);
+}
+
 static void test_post2nfa_zero_or_more() {
   const char* post = "a*";
 
@@ -0,0 +1,98 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+#include "../src/state.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+static void test_create_prog() {
+  State* accept = create_state(ACCEPT, NULL);
+  State* start = create_state('a', &accept);
+  Nfa* nfa = create_nfa(start, accept);
+
+  Prog* prog = create_prog(nfa);
+
+  assert_int_equal(prog->num_of_insts, 2);
+  assert_int_equal(prog->start, 0);
+  assert_int_equal(prog->accept, 1);
+  assert_int_equal(prog->insts[0].label, 'a');
+  assert_int_equal(prog->insts[0].outs[0], 1);
+  assert_int_equal(prog->insts[1].label, ACCEPT);
+  assert_int_equal(prog->insts[1].outs[0], -1);
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief Every state reachable from the start should be lowered, with the
+/// outs pointing to the instructions of the states they transit to.
+static void test_create_prog_should_have_dense_ids() {
+  Nfa* nfa = re2nfa("(a|b)*abb");
+
+  Prog* prog = create_prog(nfa);
+
+  assert_int_equal(prog->insts[prog->accept].label, ACCEPT);
+  for (int i = 0; i < prog->num_of_insts; i++) {
+    const Inst* inst = &prog->insts[i];
+    if (inst->label == ACCEPT) {
+      continue;
+    }
+    for (size_t j = 0; j < num_of_outs(inst->label); j++) {
+      assert_in_range(inst->outs[j], 0, prog->num_of_insts - 1);
+    }
+  }
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+static void test_copy_prog() {
+  Nfa* nfa = re2nfa("a+b?");
+  Prog* prog = create_prog(nfa);
+
+  Prog* copy = copy_prog(prog);
+
+  assert_ptr_not_equal(copy, prog);
+  assert_int_equal(copy->num_of_insts, prog->num_of_insts);
+  assert_memory_equal(copy->insts, prog->insts,
+                      sizeof(Inst) * prog->num_of_insts);
+
+  delete_prog(copy);
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
+
+/// @brief The initial instructions of a*b are the a and the b but none of the
+/// epsilon instructions in between.
+static void test_create_prog_should_precompute_follows() {
+  Nfa* nfa = re2nfa("a*b");
+  Prog* prog = create_prog(nfa);
+  const int* follow_ids = get_follow_ids(prog);
+
+  assert_int_not_equal(prog->initial_begin, -1);
+  assert_int_equal(prog->initial_end - prog->initial_begin, 2);
+  int labels = 0;
+  for (int i = prog->initial_begin; i < prog->initial_end; i++) {
+    labels |= 1 << (prog->insts[follow_ids[i]].label - 'a');
+  }
+  assert_int_equal(labels, 0x3);
+  // the a loops back to the a and the b
+  for (int i = prog->initial_begin; i < prog->initial_end; i++) {
+    const Inst* inst = &prog->insts[follow_ids[i]];
+    if (inst->label == 'a') {
+      assert_int_equal(inst->follow_end - inst->follow_begin, 2);
+    }
+  }
+
+  delete_prog(prog);
+  delete_nfa(nfa);
+}
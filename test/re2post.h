@@ -2,6 +2,8 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../src/re2post.h"
 
@@ -11,57 +13,169 @@
 #include <cmocka.h>
 // clang-format on
 
+/// @brief Asserts that re is converted to post, and frees the conversion.
+static void assert_re2post(const char* re, const char* post) {
+  char* result = re2post(re);
+  assert_string_equal(result, post);
+  free(result);
+}
+
 static void test_re2post_single_character() {
-  assert_string_equal(re2post("a"), "a");
+  assert_re2post("a", "a");
 }
 
 static void test_re2post_concat() {
-  assert_string_equal(re2post("abba"), "ab#b#a#");
+  assert_re2post("abba", "ab#b#a#");
 }
 
 static void test_re2post_union() {
-  assert_string_equal(re2post("a|b|c|d|e|f"), "abcdef|||||");
+  assert_re2post("a|b|c|d|e|f", "abcdef|||||");
 }
 
 static void test_re2post_zero_or_more() {
-  assert_string_equal(re2post("a*b"), "a*b#");
+  assert_re2post("a*b", "a*b#");
 }
 
 static void test_re2post_one_or_more() {
-  assert_string_equal(re2post("a+b"), "a+b#");
+  assert_re2post("a+b", "a+b#");
 }
 
 static void test_re2post_zero_or_one() {
-  assert_string_equal(re2post("a?b"), "a?b#");
+  assert_re2post("a?b", "a?b#");
 }
 
 static void test_re2post_any() {
-  assert_string_equal(re2post("a.b"), "a.#b#");
+  assert_re2post("a.b", "a.#b#");
 }
 
 static void test_re2post_union_and_concat() {
-  assert_string_equal(re2post("ab|ba"), "ab#ba#|");
+  assert_re2post("ab|ba", "ab#ba#|");
 }
 
 static void test_re2post_paren() {
-  assert_string_equal(re2post("(a(b(c(d(e)))))"), "abcde####");
+  assert_re2post("(a(b(c(d(e)))))", "abcde####");
 }
 
 static void test_re2post_concat_with_paren() {
-  assert_string_equal(re2post("a(bb)a"), "abb##a#");
+  assert_re2post("a(bb)a", "abb##a#");
 }
 
 static void test_re2post_union_with_paren() {
-  assert_string_equal(re2post("a|((b|c)|(d|e))|f"), "abc|de||f||");
+  assert_re2post("a|((b|c)|(d|e))|f", "abc|de||f||");
 }
 
 static void test_re2post_mix() {
-  assert_string_equal(re2post("a(bb?b.b|a|b*ab)+a"),
-                      "abb?#b#.#b#ab*a#b#||+#a#");
+  assert_re2post("a(bb?b.b|a|b*ab)+a", "abb?#b#.#b#ab*a#b#||+#a#");
+}
+
+static void test_re2post_long_re() {
+  // far longer than the buffers once used to be
+  const size_t len = 100000;
+  char* re = malloc(len + 1);
+  char* post = malloc(len * 2);
+  memset(re, 'a', len);
+  re[len] = '\0';
+  post[0] = 'a';
+  for (size_t i = 1; i < len; i++) {
+    post[i * 2 - 1] = 'a';
+    post[i * 2] = EXPLICIT_CONCAT;
+  }
+  post[len * 2 - 1] = '\0';
+  assert_re2post(re, post);
+
+  // nested as deep as it is long
+  for (size_t i = 0; i < len; i++) {
+    re[i] = i < len / 2 ? '(' : ')';
+  }
+  re[len / 2 - 1] = 'a';
+  re[len / 2] = 'b';
+  assert_re2post(re, "ab#");
+  free(re);
+  free(post);
+}
+
+/// @brief A bracket expression is a single operand, in which the operators
+/// are taken as is.
+static void test_re2post_bracket() {
+  assert_re2post("a[b|c]*", "a[b|c]*#");
+  assert_re2post("[(]|[]a-]", "[(][]a-]|");
+}
+
+static void test_re2post_ill_formed_bracket_should_return_null() {
+  assert_null(re2post("a[bc"));
+  assert_null(re2post("[z-a]"));
+}
+
+/// @brief The optional copies are nested in each other.
+static void test_re2post_counted_repetition() {
+  assert_re2post("a{3}", "aa#a#");
+  assert_re2post("a{2,}", "aa+#");
+  assert_re2post("a{0,}", "a*");
+  assert_re2post("a{2,4}", "aa#aa?#?#");
+  assert_re2post("x(ab){0,2}", "xab#ab#?#?#");
+  assert_re2post("(a|b){2}c", "ab|ab|#c#");
+}
+
+/// @brief A repetition of at most 0 times drops its operand, which leaves the
+/// empty string that any repetition keeps as is; nothing else being left is
+/// still a missing operand.
+static void test_re2post_repetition_of_zero_times() {
+  assert_re2post("ab{0}c", "ac#");
+  assert_re2post("abc{0,0}", "ab#");
+  assert_re2post("a(bc){0}d", "ad#");
+  assert_re2post("ab{0}*c+", "ac+#");
+  assert_re2post("ab{0}{2}|c", "ac|");
+  assert_null(re2post("(a{0})"));
+  assert_null(re2post("a|b{0}"));
+  assert_null(re2post("x(a|b{0})y"));
+  assert_null(re2post("x(b{0}|a)y"));
+}
+
+/// @brief A brace which doesn't start a counted repetition is taken as is.
+static void test_re2post_brace_should_be_literal() {
+  assert_re2post("a{", "a{#");
+  assert_re2post("a{,2}", "a{#,#2#}#");
+}
+
+static void test_re2post_ill_formed_counted_repetition_should_return_null() {
+  assert_null(re2post("{2}"));
+  assert_null(re2post("a{3,2}"));
+  assert_null(re2post("a{0}{3,2}"));
+}
+
+/// @brief The counted repetitions are capped, so that a few bytes of regexp
+/// can't ask for millions of states.
+static void test_re2post_too_large_repetition_should_return_null() {
+  char* post = re2post("a{1000}");
+  assert_non_null(post);
+  free(post);
+  assert_null(re2post("a{1001}"));
+  assert_null(re2post("(a{1000}){1000}"));
+}
+
+/// @brief A multibyte character is a single operand of its bytes, and so is a
+/// bracket expression of the byte sequences of its characters.
+static void test_re2post_utf8() {
+  char* post = re2post_utf8("aé+");
+  assert_string_equal(post, "a\xc3\xa9#+#");
+  free(post);
+  post = re2post_utf8("[a-bé]");
+  assert_string_equal(post, "[ab]\xc3\xa9#|");
+  free(post);
+  post = re2post_utf8(".");
+  assert_non_null(post);
+  free(post);
+}
+
+static void test_re2post_utf8_ill_formed_should_return_null() {
+  assert_null(re2post_utf8("a\xff"));
+  assert_null(re2post_utf8("\xc3"));
+  assert_null(re2post_utf8("[\xed\xa0\x80]"));
+  assert_null(re2post_utf8("[é"));
 }
 
 static void test_re2post_empty_re_should_be_empty_post() {
-  assert_string_equal(re2post(""), "");
+  assert_re2post("", "");
 }
 
 static void test_re2post_missing_operand_should_return_null() {
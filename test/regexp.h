@@ -2,6 +2,9 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../src/map.h"
 #include "../src/nfa.h"
@@ -147,7 +150,7 @@ static void test_is_accepted() {
   State* a = create_state('a', &b);
   Nfa* nfa = create_nfa(a, accept);
 
-  assert_true(is_accepted(nfa, "ab"));
+  assert_true(is_accepted(nfa, "ab", 2));
 
   delete_nfa(nfa);
 }
@@ -159,7 +162,19 @@ static void test_is_accepted_with_cache() {
   State* a = create_state('a', &b);
   Nfa* nfa = create_nfa(a, accept);
 
-  assert_true(is_accepted_with_cache(nfa, "ab"));
+  assert_true(is_accepted_with_cache(nfa, "ab", 2));
+
+  delete_nfa(nfa);
+}
+
+static void test_is_accepted_with_shift_and() {
+  // a -> b -> accept
+  State* accept = create_state(ACCEPT, NULL);
+  State* b = create_state('b', &accept);
+  State* a = create_state('a', &b);
+  Nfa* nfa = create_nfa(a, accept);
+
+  assert_true(is_accepted_with_shift_and(nfa, "ab", 2));
 
   delete_nfa(nfa);
 }
@@ -167,15 +182,14 @@ static void test_is_accepted_with_cache() {
 static void test_regexp_paren_and_zero_or_more() {
   const char* re = "(a|b)*abb";  // consists only a/b and ends with abb
 
-  const char* post = re2post(re);
-  Nfa* nfa = post2nfa(post);
+  Nfa* nfa = re2nfa(re);
 
-  assert_true(is_accepted(nfa, "abb"));
-  assert_true(is_accepted(nfa, "babb"));
-  assert_true(is_accepted(nfa, "bbbbabb"));
-  assert_true(is_accepted(nfa, "abaabbaabb"));
-  assert_false(is_accepted(nfa, "abaabbbb"));
-  assert_false(is_accepted(nfa, "abaabbab"));
+  assert_true(is_accepted(nfa, "abb", 3));
+  assert_true(is_accepted(nfa, "babb", 4));
+  assert_true(is_accepted(nfa, "bbbbabb", 7));
+  assert_true(is_accepted(nfa, "abaabbaabb", 10));
+  assert_false(is_accepted(nfa, "abaabbbb", 8));
+  assert_false(is_accepted(nfa, "abaabbab", 8));
 
   delete_nfa(nfa);
 }
@@ -183,15 +197,29 @@ static void test_regexp_paren_and_zero_or_more() {
 static void test_regexp_paren_and_zero_or_more_with_cache() {
   const char* re = "(a|b)*abb";  // consists only a/b and ends with abb
 
-  const char* post = re2post(re);
-  Nfa* nfa = post2nfa(post);
+  Nfa* nfa = re2nfa(re);
+
+  assert_true(is_accepted_with_cache(nfa, "abb", 3));
+  assert_true(is_accepted_with_cache(nfa, "babb", 4));
+  assert_true(is_accepted_with_cache(nfa, "bbbbabb", 7));
+  assert_true(is_accepted_with_cache(nfa, "abaabbaabb", 10));
+  assert_false(is_accepted_with_cache(nfa, "abaabbbb", 8));
+  assert_false(is_accepted_with_cache(nfa, "abaabbab", 8));
+
+  delete_nfa(nfa);
+}
+
+static void test_regexp_paren_and_zero_or_more_with_shift_and() {
+  const char* re = "(a|b)*abb";  // consists only a/b and ends with abb
+
+  Nfa* nfa = re2nfa(re);
 
-  assert_true(is_accepted_with_cache(nfa, "abb"));
-  assert_true(is_accepted_with_cache(nfa, "babb"));
-  assert_true(is_accepted_with_cache(nfa, "bbbbabb"));
-  assert_true(is_accepted_with_cache(nfa, "abaabbaabb"));
-  assert_false(is_accepted_with_cache(nfa, "abaabbbb"));
-  assert_false(is_accepted_with_cache(nfa, "abaabbab"));
+  assert_true(is_accepted_with_shift_and(nfa, "abb", 3));
+  assert_true(is_accepted_with_shift_and(nfa, "babb", 4));
+  assert_true(is_accepted_with_shift_and(nfa, "bbbbabb", 7));
+  assert_true(is_accepted_with_shift_and(nfa, "abaabbaabb", 10));
+  assert_false(is_accepted_with_shift_and(nfa, "abaabbbb", 8));
+  assert_false(is_accepted_with_shift_and(nfa, "abaabbab", 8));
 
   delete_nfa(nfa);
 }
@@ -199,13 +227,12 @@ static void test_regexp_paren_and_zero_or_more_with_cache() {
 static void test_regexp_any_and_one_or_more() {
   const char* re = ".+";
 
-  const char* post = re2post(re);
-  Nfa* nfa = post2nfa(post);
+  Nfa* nfa = re2nfa(re);
 
-  assert_true(is_accepted(nfa, "a"));
-  assert_true(is_accepted(nfa, "ab"));
-  assert_true(is_accepted(nfa, "abc"));
-  assert_false(is_accepted(nfa, ""));
+  assert_true(is_accepted(nfa, "a", 1));
+  assert_true(is_accepted(nfa, "ab", 2));
+  assert_true(is_accepted(nfa, "abc", 3));
+  assert_false(is_accepted(nfa, "", 0));
 
   delete_nfa(nfa);
 }
@@ -213,13 +240,454 @@ static void test_regexp_any_and_one_or_more() {
 static void test_regexp_any_and_one_or_more_with_cache() {
   const char* re = ".+";
 
-  const char* post = re2post(re);
-  Nfa* nfa = post2nfa(post);
+  Nfa* nfa = re2nfa(re);
+
+  assert_true(is_accepted_with_cache(nfa, "a", 1));
+  assert_true(is_accepted_with_cache(nfa, "ab", 2));
+  assert_true(is_accepted_with_cache(nfa, "abc", 3));
+  assert_false(is_accepted_with_cache(nfa, "", 0));
+
+  delete_nfa(nfa);
+}
+
+static void test_regexp_any_and_one_or_more_with_shift_and() {
+  const char* re = ".+";
+
+  Nfa* nfa = re2nfa(re);
 
-  assert_true(is_accepted_with_cache(nfa, "a"));
-  assert_true(is_accepted_with_cache(nfa, "ab"));
-  assert_true(is_accepted_with_cache(nfa, "abc"));
-  assert_false(is_accepted_with_cache(nfa, ""));
+  assert_true(is_accepted_with_shift_and(nfa, "a", 1));
+  assert_true(is_accepted_with_shift_and(nfa, "ab", 2));
+  assert_true(is_accepted_with_shift_and(nfa, "abc", 3));
+  assert_false(is_accepted_with_shift_and(nfa, "", 0));
 
   delete_nfa(nfa);
 }
+
+/// @brief ? and nested groups, with more positions than a chunk of the state
+/// word holds.
+static void test_regexp_zero_or_one_with_shift_and() {
+  const char* re = "a?(b|cd)*e?(f.g)+h?i?j?";
+
+  Nfa* nfa = re2nfa(re);
+
+  assert_true(is_accepted_with_shift_and(nfa, "fxg", 3));
+  assert_true(is_accepted_with_shift_and(nfa, "abcdbefxgfygj", 13));
+  assert_true(is_accepted_with_shift_and(nfa, "cdcdfgghij", 10));
+  assert_false(is_accepted_with_shift_and(nfa, "abcefxg", 7));
+  assert_false(is_accepted_with_shift_and(nfa, "fxgjh", 5));
+  assert_false(is_accepted_with_shift_and(nfa, "aa", 2));
+
+  delete_nfa(nfa);
+}
+
+static void test_compile_regexp_ill_formed_should_return_null() {
+  assert_null(compile_regexp("a|", NULL));
+  assert_null(compile_regexp("a(bc", NULL));
+  assert_null(compile_regexp("", NULL));
+}
+
+static void test_match_regexp_many_strings() {
+  Regexp* regexp = compile_regexp("(a|b)*abb", NULL);
+
+  assert_non_null(regexp);
+  assert_true(match_regexp(regexp, "abb"));
+  assert_true(match_regexp(regexp, "babb"));
+  assert_false(match_regexp(regexp, "abaabbbb"));
+  assert_true(match_regexp(regexp, "bbbbabb"));
+  assert_false(match_regexp(regexp, ""));
+
+  delete_regexp(regexp);
+}
+
+/// @brief The DFA states built on matching one string are reused by the next,
+/// which should not affect the results.
+static void test_match_regexp_many_strings_with_cache() {
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.cache = true;
+  Regexp* regexp = compile_regexp("(a|b)*abb", &options);
+
+  assert_non_null(regexp);
+  assert_true(match_regexp(regexp, "abb"));
+  assert_true(match_regexp(regexp, "babb"));
+  assert_false(match_regexp(regexp, "abaabbbb"));
+  assert_true(match_regexp(regexp, "bbbbabb"));
+  assert_false(match_regexp(regexp, ""));
+
+  delete_regexp(regexp);
+}
+
+/// @brief The position automaton should match the same strings with each of
+/// the engines.
+static void test_match_regexp_with_glushkov() {
+  RegexpOptions options[3];
+  for (int i = 0; i < 3; i++) {
+    init_regexp_options(&options[i]);
+    options[i].glushkov = true;
+  }
+  options[1].cache = true;
+  options[2].dfa = true;
+
+  for (int i = 0; i < 3; i++) {
+    Regexp* regexp = compile_regexp("(a|b)*a(b+|.?)", &options[i]);
+
+    assert_non_null(regexp);
+    assert_null(get_regexp_nfa(regexp));
+    assert_true(match_regexp(regexp, "a"));
+    assert_true(match_regexp(regexp, "babbb"));
+    assert_true(match_regexp(regexp, "bbac"));
+    assert_false(match_regexp(regexp, "bbacc"));
+    assert_false(match_regexp(regexp, ""));
+
+    delete_regexp(regexp);
+  }
+  assert_null(compile_regexp("a(bc", &options[0]));
+}
+
+/// @brief A bracket expression should match any of its bytes with both
+/// constructions and each of the engines, with or without simplification.
+static void test_match_regexp_with_class() {
+  for (int i = 0; i < 12; i++) {
+    RegexpOptions options;
+    init_regexp_options(&options);
+    options.glushkov = i & 1;
+    options.simplify = i & 2;
+    options.cache = i / 4 == 1;
+    options.dfa = i / 4 == 2;
+    Regexp* regexp = compile_regexp("[a-c]+-[^0-9]|[]x]?", &options);
+
+    assert_non_null(regexp);
+    assert_true(match_regexp(regexp, "abca-x"));
+    assert_true(match_regexp(regexp, "c-]"));
+    assert_true(match_regexp(regexp, "]"));
+    assert_true(match_regexp(regexp, ""));
+    assert_false(match_regexp(regexp, "a-5"));
+    assert_false(match_regexp(regexp, "d-x"));
+    assert_false(match_regexp(regexp, "a-"));
+
+    delete_regexp(regexp);
+  }
+  assert_null(compile_regexp("[a-", NULL));
+}
+
+/// @brief A counted repetition should match between its bounds with both
+/// constructions and each of the engines.
+static void test_match_regexp_with_counted_repetition() {
+  for (int i = 0; i < 6; i++) {
+    RegexpOptions options;
+    init_regexp_options(&options);
+    options.glushkov = i & 1;
+    options.cache = i / 2 == 1;
+    options.dfa = i / 2 == 2;
+    Regexp* regexp = compile_regexp("x[ab]{2,4}(yz){2,}", &options);
+
+    assert_non_null(regexp);
+    assert_true(match_regexp(regexp, "xabyzyz"));
+    assert_true(match_regexp(regexp, "xbbbbyzyzyz"));
+    assert_false(match_regexp(regexp, "xayzyz"));
+    assert_false(match_regexp(regexp, "xaaaaayzyz"));
+    assert_false(match_regexp(regexp, "xabyz"));
+
+    delete_regexp(regexp);
+
+    regexp = compile_regexp("ab{0}c", &options);
+    assert_non_null(regexp);
+    assert_true(match_regexp(regexp, "ac"));
+    assert_false(match_regexp(regexp, "abc"));
+
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief A . and a bracket expression match a character in UTF-8, so a lone
+/// byte of a multibyte character doesn't match them.
+static void test_match_regexp_utf8() {
+  for (int i = 0; i < 6; i++) {
+    RegexpOptions options;
+    init_regexp_options(&options);
+    options.glushkov = i & 1;
+    options.cache = i / 2 == 1;
+    options.dfa = i / 2 == 2;
+    options.utf8 = true;
+    Regexp* regexp = compile_regexp("[α-ω]+.{2}é?", &options);
+
+    assert_non_null(regexp);
+    assert_true(match_regexp(regexp, "λογοςéa"));
+    assert_true(match_regexp(regexp, "αa\xf0\x9f\x98\x80é"));
+    assert_false(match_regexp(regexp, "λa"));
+    assert_false(match_regexp(regexp, "λ\xc3\xa9"));
+    assert_false(match_regexp(regexp, "λa\xff"));
+    assert_false(match_regexp(regexp, "Aab"));
+
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief A byte above 0x7f is labeled as an unsigned char, so that it's never
+/// taken as one of the labels which aren't bytes, whatever the sign of char.
+static void test_match_regexp_high_bytes() {
+  for (int i = 0; i < 2; i++) {
+    RegexpOptions options;
+    init_regexp_options(&options);
+    options.glushkov = i;
+    Regexp* regexp = compile_regexp("\x80\x84+", &options);
+
+    assert_non_null(regexp);
+    const Prog* prog = get_regexp_prog(regexp);
+    for (int j = 0; j < prog->num_of_insts; j++) {
+      const int label = prog->insts[j].label;
+      if (label < EPSILON) {
+        assert_true(label == 0x80 || label == 0x84);
+      }
+    }
+    assert_true(match_regexp(regexp, "\x80\x84\x84"));
+    assert_false(match_regexp(regexp, "\x80\x83"));
+    assert_false(match_regexp(regexp, "\x80"));
+
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief The bytes are matched by length, so a null byte is taken as any other
+/// byte and a slice is matched without the bytes after it.
+static void test_match_regexp_n() {
+  const char buf[] = "xab\0\xff\0by";
+  for (int i = 0; i < 6; i++) {
+    RegexpOptions options;
+    init_regexp_options(&options);
+    options.glushkov = i & 1;
+    options.cache = i / 2 == 1;
+    options.dfa = i / 2 == 2;
+    Regexp* regexp = compile_regexp("ab[^a]+b", &options);
+
+    assert_non_null(regexp);
+    assert_true(match_regexp_n(regexp, buf + 1, 6));
+    assert_false(match_regexp_n(regexp, buf + 1, 7));
+    assert_false(match_regexp_n(regexp, buf + 1, 3));
+    assert_false(match_regexp(regexp, buf + 1));
+
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief A string fed in chunks, split anywhere, is matched as if it were fed
+/// at once, with each of the engines.
+static void test_regexp_stream() {
+  const char* res[] = {"(a|b)*abb", "(a|b)*a(a|b){70}",
+                       "(abcde|b)*(abcde){900}"};
+  const char* strings[] = {"", "abb", "babbab", "bababb", "abbb"};
+  for (int i = 0; i < 9; i++) {
+    RegexpOptions options;
+    init_regexp_options(&options);
+    options.cache = i % 3 == 1;
+    options.dfa = i % 3 == 2;
+    Regexp* regexp = compile_regexp(res[i / 3], &options);
+    assert_non_null(regexp);
+
+    for (size_t j = 0; j < sizeof(strings) / sizeof(strings[0]); j++) {
+      const size_t len = strlen(strings[j]);
+      const bool expected = match_regexp_n(regexp, strings[j], len);
+      for (size_t split = 0; split <= len; split++) {
+        RegexpStream* stream = create_regexp_stream(regexp);
+        feed_regexp_stream(stream, strings[j], split);
+        feed_regexp_stream(stream, strings[j] + split, 0);
+        feed_regexp_stream(stream, strings[j] + split, len - split);
+
+        assert_int_equal(finish_regexp_stream(stream), expected);
+        delete_regexp_stream(stream);
+      }
+    }
+    // the stream can be fed after it's finished
+    RegexpStream* stream = create_regexp_stream(regexp);
+    feed_regexp_stream(stream, "ab", 2);
+    const bool accepted = finish_regexp_stream(stream);
+    feed_regexp_stream(stream, "b", 1);
+    assert_int_equal(accepted, match_regexp(regexp, "ab"));
+    assert_int_equal(finish_regexp_stream(stream), match_regexp(regexp, "abb"));
+    delete_regexp_stream(stream);
+
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief A pattern far longer than the buffers once used to be, such as an
+/// alternation of many words, should compile with both constructions.
+static void test_compile_regexp_long_alternation() {
+  const int num_of_words = 10000;
+  // each word is "w" followed by 5 digits and a "|"
+  char* re = malloc(num_of_words * 7 + 1);
+  for (int i = 0; i < num_of_words; i++) {
+    sprintf(re + i * 7, "w%05d|", i);
+  }
+  re[num_of_words * 7 - 1] = '\0';
+  RegexpOptions options;
+  init_regexp_options(&options);
+
+  for (int glushkov = 0; glushkov < 2; glushkov++) {
+    options.glushkov = glushkov;
+    Regexp* regexp = compile_regexp(re, &options);
+
+    assert_non_null(regexp);
+    assert_true(match_regexp(regexp, "w00000"));
+    assert_true(match_regexp(regexp, "w09999"));
+    assert_false(match_regexp(regexp, "w10000"));
+    assert_false(match_regexp(regexp, "w0000"));
+
+    delete_regexp(regexp);
+  }
+  free(re);
+}
+
+/// @brief A regexp whose position automaton has too large follows is compiled
+/// with Thompson's construction instead.
+static void test_compile_regexp_glushkov_falls_back() {
+  const int num_of_alts = 1100;
+  // "a|" for each alternative in a starred group
+  char* re = malloc(num_of_alts * 2 + 3);
+  re[0] = '(';
+  for (int i = 0; i < num_of_alts; i++) {
+    sprintf(re + 1 + i * 2, "a|");
+  }
+  strcpy(re + num_of_alts * 2, ")*");
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.glushkov = true;
+  options.simplify = false;
+
+  Regexp* regexp = compile_regexp(re, &options);
+
+  assert_non_null(regexp);
+  assert_non_null(get_regexp_nfa(regexp));
+  assert_true(match_regexp(regexp, "aaa"));
+  assert_false(match_regexp(regexp, "ab"));
+
+  delete_regexp(regexp);
+  free(re);
+}
+
+/// @brief The workspaces of the caller should match the same strings as the
+/// regexp does on its own, whichever engine the regexp picks.
+static void test_match_regexp_with_scratch() {
+  // more positions than a word has, so it's simulated with bitsets
+  char long_re[512] = "(a|b)*abb";
+  for (int i = 0; i < 70; i++) {
+    strcat(long_re, "(c|d)?");
+  }
+  const char* res[] = {"(a|b)*abb", long_re, "(a|b)*abb", "(a|b)*abb"};
+  RegexpOptions options[4];
+  for (int i = 0; i < 4; i++) {
+    init_regexp_options(&options[i]);
+  }
+  options[2].cache = true;
+  options[3].dfa = true;
+
+  for (int i = 0; i < 4; i++) {
+    Regexp* regexp = compile_regexp(res[i], &options[i]);
+    assert_non_null(regexp);
+    const size_t size = get_regexp_scratch_size(regexp);
+    void* memory = size ? malloc(size) : NULL;
+    RegexpScratch* scratch = init_regexp_scratch(regexp, memory);
+
+    assert_true(match_regexp_with_scratch(regexp, scratch, "babb", 4));
+    assert_false(match_regexp_with_scratch(regexp, scratch, "abab", 4));
+    assert_int_equal(match_regexp_with_scratch(regexp, scratch, "abbcd", 5),
+                     match_regexp(regexp, "abbcd"));
+
+    free(memory);
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief Each matcher has a DFA cache of its own, so the regexp's stays
+/// empty.
+static void test_match_regexp_with_matcher() {
+  RegexpOptions options[2];
+  for (int i = 0; i < 2; i++) {
+    init_regexp_options(&options[i]);
+  }
+  options[1].cache = true;
+
+  for (int i = 0; i < 2; i++) {
+    Regexp* regexp = compile_regexp("(a|b)*abb", &options[i]);
+    RegexpMatcher* matcher = create_regexp_matcher(regexp);
+    RegexpMatcher* other = create_regexp_matcher(regexp);
+
+    assert_true(match_regexp_with_matcher(matcher, "babb", 4));
+    assert_false(match_regexp_with_matcher(other, "abab", 4));
+    assert_true(match_regexp_with_matcher(other, "abb", 3));
+    RegexpStats stats;
+    get_regexp_stats(regexp, &stats);
+    assert_true(stats.num_of_dstates <= 1);
+
+    delete_regexp_matcher(other);
+    delete_regexp_matcher(matcher);
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief Every engine finds the regexp anywhere in the string, and the DFAs
+/// stay as small as the regexp's own.
+static void test_search_regexp() {
+  // more positions than a word has, so it's simulated with bitsets
+  char long_re[512] = "ab+a";
+  for (int i = 0; i < 70; i++) {
+    strcat(long_re, "(c|d)?");
+  }
+  const char* res[] = {".*ab+a", long_re, "ab+a.*", "ab+a", "ab+a"};
+  RegexpOptions options[5];
+  for (int i = 0; i < 5; i++) {
+    init_regexp_options(&options[i]);
+    options[i].search = true;
+  }
+  options[2].cache = true;
+  options[3].dfa = true;
+  options[4].glushkov = true;
+
+  for (int i = 0; i < 5; i++) {
+    Regexp* regexp = compile_regexp(res[i], &options[i]);
+    assert_non_null(regexp);
+
+    assert_true(match_regexp(regexp, "xxabbbaxx"));
+    assert_true(match_regexp(regexp, "aba"));
+    assert_false(match_regexp(regexp, "abbxa"));
+    assert_false(match_regexp(regexp, ""));
+    RegexpStats stats;
+    get_regexp_stats(regexp, &stats);
+    assert_true(stats.num_of_dstates <= 4);
+    assert_true(stats.num_of_dfa_states <= 4);
+
+    delete_regexp(regexp);
+  }
+}
+
+/// @brief A search rejects the strings without the literal before any
+/// automaton runs, which doesn't change the results.
+static void test_search_regexp_with_literal() {
+  RegexpOptions options;
+  init_regexp_options(&options);
+  options.search = true;
+  options.cache = true;
+  Regexp* regexp = compile_regexp(".*ERROR: (a|b)+.*", &options);
+  size_t len;
+  const char* literal = get_regexp_literal(regexp, &len);
+
+  assert_int_equal(len, 7);
+  assert_memory_equal(literal, "ERROR: ", 7);
+  assert_true(match_regexp(regexp, "12:00 ERROR: abba"));
+  assert_false(match_regexp(regexp, "12:00 ERROR: cab"));
+  assert_false(match_regexp(regexp, "12:00 WARN: abba"));
+  RegexpStats stats;
+  get_regexp_stats(regexp, &stats);
+  // only the string with the literal built any DFA state beyond the start
+  const size_t num_of_dstates = stats.num_of_dstates;
+  assert_false(match_regexp(regexp, "ab ab ab ab"));
+  get_regexp_stats(regexp, &stats);
+  assert_int_equal(stats.num_of_dstates, num_of_dstates);
+
+  Regexp* without_literal = compile_regexp("(a|b)*", &options);
+  assert_null(get_regexp_literal(without_literal, &len));
+  assert_int_equal(len, 0);
+
+  delete_regexp(without_literal);
+  delete_regexp(regexp);
+}
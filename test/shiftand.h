@@ -0,0 +1,42 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/post2nfa.h"
+#include "../src/prog.h"
+#include "../src/re2post.h"
+#include "../src/shiftand.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+/// @brief 63 symbols and the accepting state fit, but one more doesn't.
+static void test_create_shift_and_too_many_positions() {
+  char re[65] = {0};
+  for (int i = 0; i < 63; i++) {
+    re[i] = 'a';
+  }
+  Nfa* fit = re2nfa(re);
+  Prog* fit_prog = create_prog(fit);
+  re[63] = 'a';
+  Nfa* not_fit = re2nfa(re);
+  Prog* not_fit_prog = create_prog(not_fit);
+
+  ShiftAnd* shift_and = create_shift_and(fit_prog);
+
+  assert_non_null(shift_and);
+  assert_true(run_shift_and(shift_and, re + 1, strlen(re + 1)));
+  assert_false(run_shift_and(shift_and, re, strlen(re)));
+  assert_null(create_shift_and(not_fit_prog));
+
+  delete_shift_and(shift_and);
+  delete_prog(not_fit_prog);
+  delete_nfa(not_fit);
+  delete_prog(fit_prog);
+  delete_nfa(fit);
+}
@@ -0,0 +1,65 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../src/sparseset.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+static void test_sparse_set_insert_and_contains() {
+  SparseSet* set = create_sparse_set(10);
+
+  insert_sparse_set(set, 3);
+  insert_sparse_set(set, 9);
+  insert_sparse_set(set, 3);
+
+  assert_int_equal(set->size, 2);
+  assert_true(contains_sparse_set(set, 3));
+  assert_true(contains_sparse_set(set, 9));
+  assert_false(contains_sparse_set(set, 0));
+  // in the order of insertion
+  assert_int_equal(set->dense[0], 3);
+  assert_int_equal(set->dense[1], 9);
+
+  delete_sparse_set(set);
+}
+
+/// @brief The positions left in sparse by the cleared members shouldn't make
+/// them members again.
+static void test_sparse_set_clear() {
+  SparseSet* set = create_sparse_set(10);
+  insert_sparse_set(set, 3);
+  insert_sparse_set(set, 5);
+
+  clear_sparse_set(set);
+  insert_sparse_set(set, 5);
+
+  assert_int_equal(set->size, 1);
+  assert_false(contains_sparse_set(set, 3));
+  assert_true(contains_sparse_set(set, 5));
+
+  delete_sparse_set(set);
+}
+
+/// @brief A set laid out in memory of the caller should work as an allocated
+/// one does.
+static void test_init_sparse_set() {
+  void* memory = malloc(get_sparse_set_size(10));
+  SparseSet* set = init_sparse_set(memory, 10);
+
+  insert_sparse_set(set, 9);
+  insert_sparse_set(set, 0);
+
+  assert_int_equal(set->size, 2);
+  assert_true(contains_sparse_set(set, 9));
+  assert_true(contains_sparse_set(set, 0));
+  assert_false(contains_sparse_set(set, 5));
+
+  free(memory);
+}
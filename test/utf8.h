@@ -0,0 +1,119 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../src/utf8.h"
+
+// clang-format off
+// cmocka allows test applications to use custom definitions of C standard
+// library functions and types by having us include the necessary headers.
+#include <cmocka.h>
+// clang-format on
+
+static void test_decode_utf8() {
+  int code_point;
+
+  assert_int_equal(decode_utf8("a", &code_point), 1);
+  assert_int_equal(code_point, 'a');
+  assert_int_equal(decode_utf8("\xc3\xa9", &code_point), 2);
+  assert_int_equal(code_point, 0xE9);
+  assert_int_equal(decode_utf8("\xe2\x82\xac", &code_point), 3);
+  assert_int_equal(code_point, 0x20AC);
+  assert_int_equal(decode_utf8("\xf4\x8f\xbf\xbf", &code_point), 4);
+  assert_int_equal(code_point, MAX_CODE_POINT);
+}
+
+/// @brief Overlong encodings, surrogates, code points beyond U+10FFFF, stray
+/// continuation bytes and truncated characters aren't well-formed.
+static void test_decode_utf8_ill_formed_should_return_0() {
+  int code_point;
+
+  assert_int_equal(decode_utf8("\xc0\xaf", &code_point), 0);
+  assert_int_equal(decode_utf8("\xe0\x80\xaf", &code_point), 0);
+  assert_int_equal(decode_utf8("\xed\xa0\x80", &code_point), 0);
+  assert_int_equal(decode_utf8("\xf4\x90\x80\x80", &code_point), 0);
+  assert_int_equal(decode_utf8("\x80", &code_point), 0);
+  assert_int_equal(decode_utf8("\xff", &code_point), 0);
+  assert_int_equal(decode_utf8("\xe2\x82", &code_point), 0);
+}
+
+static void test_encode_utf8() {
+  const int code_points[] = {0, 0x7F, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10000,
+                             MAX_CODE_POINT};
+  for (size_t i = 0; i < sizeof(code_points) / sizeof(code_points[0]); i++) {
+    char bytes[MAX_UTF8_LEN + 1] = {0};
+    int decoded = -1;
+    const int len = encode_utf8(code_points[i], (unsigned char*)bytes);
+
+    if (code_points[i] == 0) {
+      assert_int_equal(len, 1);
+      assert_int_equal(bytes[0], 0);
+      continue;
+    }
+    assert_int_equal(decode_utf8(bytes, &decoded), len);
+    assert_int_equal(decoded, code_points[i]);
+  }
+}
+
+static void test_parse_code_point_set() {
+  CodePointSet* set = create_code_point_set();
+
+  const char* s = "[α-ωa]b";
+  assert_ptr_equal(parse_code_point_set(s, set), s + 8);
+  assert_int_equal(set->size, 2);
+  assert_int_equal(set->ranges[0].low, 'a');
+  assert_int_equal(set->ranges[1].low, 0x3B1);
+  assert_int_equal(set->ranges[1].high, 0x3C9);
+
+  // the complement is taken over all the code points
+  assert_non_null(parse_code_point_set("[^b-d]", set));
+  assert_int_equal(set->size, 2);
+  assert_int_equal(set->ranges[0].high, 'a');
+  assert_int_equal(set->ranges[1].low, 'e');
+  assert_int_equal(set->ranges[1].high, MAX_CODE_POINT);
+
+  assert_null(parse_code_point_set("[ω-α]", set));
+  assert_null(parse_code_point_set("[\xff]", set));
+  assert_null(parse_code_point_set("[é", set));
+
+  delete_code_point_set(set);
+}
+
+/// @brief A range is split by the length of encoding and at the boundaries of
+/// the continuation bytes, and an operator is written as a bracket expression.
+static void test_code_point_set2post() {
+  const struct {
+    int low;
+    int high;
+    const char* post;
+  } cases[] = {
+      {'a', 'a', "a"},
+      {'.', '.', "[.]"},
+      {0x80, 0x7FF, "[\xc2-\xdf][\x80-\xbf]#"},
+      {0x7F, 0x80, "\x7f\xc2\x80#|"},
+      {0xE9, 0xE9, "\xc3\xa9#"},
+      {0x3B1, 0x3C9, "\xce[\xb1-\xbf]#\xcf[\x80-\x89]#|"},
+      {0xD7FF, 0xE000, "\xed\x9f#\xbf#\xee\x80#\x80#|"},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    CodePointSet* set = create_code_point_set();
+    insert_code_point_range(set, cases[i].low, cases[i].high);
+
+    char* post = code_point_set2post(set);
+
+    assert_string_equal(post, cases[i].post);
+    free(post);
+    delete_code_point_set(set);
+  }
+}
+
+static void test_code_point_set2post_of_surrogates_should_return_null() {
+  CodePointSet* set = create_code_point_set();
+  insert_code_point_range(set, 0xD800, 0xDFFF);
+
+  assert_null(code_point_set2post(set));
+
+  delete_code_point_set(set);
+}